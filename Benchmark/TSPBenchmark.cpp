@@ -0,0 +1,78 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "SkyWatcher/Cerebrum.h"
+
+// Compares the lattice solver against the OR-tools search (single and parallel portfolio) on 5x5, 10x10 and 20x20 sectors, for every region's starting corner,
+// and reports the time to build the distance matrix.
+// Usage: ./TSPBenchmark [orToolsTimeLimitSeconds] [latticeRepetitions]
+
+namespace {
+    template <int Side>
+    typename SectorGeometry<Side>::Waypoints sectorWaypoints() {
+        typename SectorGeometry<Side>::Waypoints waypoints{};
+        for (int i = 0; i < Side; i++)
+            for (int j = 0; j < Side; j++)
+                waypoints[i * Side + j] = {(j + 0.5) * CELL_SIZE, (i + 0.5) * CELL_SIZE};
+        return waypoints;
+    }
+
+    void printRow(const std::string &solver, const int start, const double length, const double ms) {
+        std::cout << std::left << std::setw(11) << solver
+                  << std::right << std::setw(8) << start
+                  << std::setw(14) << std::fixed << std::setprecision(1) << length
+                  << std::setw(16) << std::setprecision(3) << ms << std::endl;
+    }
+
+    template <int Side>
+    void benchmark(const int timeLimit, const int repetitions) {
+        using Geometry = SectorGeometry<Side>;
+        const auto waypoints = sectorWaypoints<Side>();
+        const std::vector<Position> positions(waypoints.begin(), waypoints.end());
+
+        std::cout << std::endl << Side << "x" << Side << " sector, optimal tour length: "
+                  << std::fixed << std::setprecision(1) << positions.size() * CELL_SIZE << " m" << std::endl;
+        // Distance matrix shared by the solvers
+        const auto matrixBegin = std::chrono::steady_clock::now();
+        for (int i = 0; i < repetitions; i++) {
+            const DistanceMatrix matrix(waypoints.data(), waypoints.size());
+        }
+        std::cout << "Distance matrix (" << (DistanceMatrix::usesAvx2() ? "avx2" : "scalar") << "): " << std::setprecision(3)
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - matrixBegin).count() / repetitions << " ms" << std::endl;
+
+        std::cout << std::left << std::setw(11) << "solver" << std::right << std::setw(8) << "start"
+                  << std::setw(14) << "length [m]" << std::setw(16) << "time [ms]" << std::endl;
+
+        for (const int start : Geometry::startingIndex) {
+            // Lattice solver, averaged over several runs since a single solve is below timer resolution
+            std::vector<int> tour;
+            auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < repetitions; i++) {
+                const LatticeSolver lattice(positions);
+                tour = lattice.solve(start);
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / repetitions;
+            printRow("lattice", start, LatticeSolver::tourLength(tour, positions), ms);
+
+            begin = std::chrono::steady_clock::now();
+            tour = BasicCerebrum<Side>::solveWithOrTools(waypoints, start, timeLimit);
+            ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            printRow("or-tools", start, tour.empty() ? 0 : LatticeSolver::tourLength(tour, positions), ms);
+
+            begin = std::chrono::steady_clock::now();
+            tour = BasicCerebrum<Side>::solveWithPortfolio(waypoints, start, timeLimit);
+            ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            printRow("portfolio", start, tour.empty() ? 0 : LatticeSolver::tourLength(tour, positions), ms);
+        }
+    }
+}
+
+int main(const int argc, char* argv[]) {
+    const int timeLimit = argc > 1 ? std::stoi(argv[1]) : 3;
+    const int repetitions = argc > 2 ? std::stoi(argv[2]) : 100;
+
+    benchmark<5>(timeLimit, repetitions);
+    benchmark<10>(timeLimit, repetitions);
+    benchmark<20>(timeLimit, repetitions);
+    return 0;
+}
@@ -12,33 +12,38 @@ constexpr float cellTravelTime = 20.0 / (30.0 / 3.6);
 
 
 // Constructor
-Drone::Drone(const int timeScale) : redisClient(RedisCommunication("127.0.0.1", 6379).get_redis_instance(), timeScale), timeScale(timeScale) {
+Drone::Drone(const std::shared_ptr<DroneMultiplexer> &multiplexer, const int timeScale, const wire::Encoding encoding,
+             const StatusLogOptions &statusLog, const bool pushStatus)
+    : clock(timeScale), redisClient(multiplexer, timeScale, encoding), timeScale(timeScale) {
+    redisClient.set_status_log(statusLog);
+    redisClient.set_status_push(pushStatus);
     this->batteryLevel = 100.0; // Initialize battery level at maximum
     this->state = DroneState::Ready;
     this->consumptionRatio = 1.0;
     //this->consumptionRate = 100.0 / (flightAutonomy * 60.0);  // consumptionRate/second
 
     // Initialize connection to tower
-    redisClient.connect_to_tower([this](nlohmann::json init_message) {  // Lambda function to assign droneID, could be a member function
+    redisClient.connect_to_tower([this](const wire::InitMessage& init_message) {  // Lambda function to assign droneID, could be a member function
         // Init_message parse
-        this->ID = init_message["drone_id"];
-        this->towerPosition = init_message["tower_position"];
-        this->position = this->towerPosition;
-
-        // Start the status update thread
-        std::thread statusUpdateThread(&Drone::statusUpdateThread, this);
-        statusUpdateThread.detach();
+        this->ID = init_message.droneID;
+        this->rng = Random::generator(static_cast<uint64_t>(this->ID));
+        this->towerPosition = init_message.towerPosition;
+        {
+            std::lock_guard lock(positionMutex);
+            this->trajectory.reset(this->towerPosition);
+        }
 
-        std::thread batteryUpdateThread(&Drone::batteryUpdateThread, this);
-        batteryUpdateThread.detach();
+        // Start the status and battery updates
+        startStatusUpdates();
+        startBatteryUpdates();
 
-        if(init_message.contains("timer")) {
-            const int sleepTime = init_message["timer"];
-            const Position startPoint = init_message["starting_point"];
-            const std::array<Position, 100> tsp = init_message["tsp"];
+        std::thread pathUpdateThread(&Drone::pathUpdateThread, this);
+        pathUpdateThread.detach();
 
+        if(init_message.assignment) {
             // Initialize operation
-            this->receiveDestination(startPoint, sleepTime, tsp, true);
+            const auto& [path, sleepTime] = *init_message.assignment;
+            this->receiveDestination(path.startingPoint, sleepTime, *path.tsp, true);
         }
         else {
             wait_for_path();
@@ -49,27 +54,27 @@ Drone::Drone(const int timeScale) : redisClient(RedisCommunication("127.0.0.1",
 }
 
 void Drone::wait_for_path() {
-    redisClient.listen_for_commands([this](const nlohmann::json& command)
+    redisClient.listen_for_commands([this](const wire::Assignment& command)
     {
-        const Position startPoint = command["starting_point"];
-        const int sleepTime = command["timer"];
-        const std::array<Position, 100> tsp = command["tsp"];
-
-        this->receiveDestination(startPoint, sleepTime, tsp, false);
+        this->receiveDestination(command.path.startingPoint, command.timer, *command.path.tsp, false);
     });
 }
 
 // Receive new path from the tower
 // init=true if it's called from the constructor, else init=false
 void Drone::receiveDestination(const Position destPoint, const int sleepTime,
-                               const std::array<Position, 100>& waypoints, const bool init = false) {
+                               const Sector::Waypoints& waypoints, const bool init = false) {
     if (this->state == DroneState::Ready) {
+        {
+            // Updates meant for a previously patrolled sector no longer apply
+            std::lock_guard lock(pathMutex);
+            pendingPath.reset();
+        }
         if(init)
-            std::this_thread::sleep_for(std::chrono::seconds(6));
+            clock.sleepFor(6.0 * timeScale);
 
         // Initialize Path's parameters
-        const double distance = utils::calculateDistance(this->position, destPoint);
-        const float travelTime = utils::calculateTime(distance, speed);
+        const float travelTime = Drone::travelTime(this->getPosition(), destPoint);
 
 
         // Drone Arriving
@@ -90,17 +95,33 @@ void Drone::receiveDestination(const Position destPoint, const int sleepTime,
 
 
         // Thead for subsequent drone call
-        const nlohmann::json message = {{"drone_id", this->ID}};
-        redisClient.start_sleeping_thread(message, sleepTime - travelTime);
+        {
+            std::lock_guard lock(stateMutex);
+            handoffTimer = redisClient.schedule_go_next(clock.deadline(clock.now() + sleepTime - travelTime));
+        }
         // Drone Monitoring
         this->changeState(DroneState::Monitoring);
         const int cycleIteration = this->getCycleIteration(sleepTime);
-        const double wp_distance = utils::calculateDistance(waypoints[0], waypoints[1]);
-        const float wp_travelTime = utils::calculateTime(wp_distance, speed);
+        const float wp_travelTime = Drone::travelTime(waypoints[0], waypoints[1]);
+        Sector::Waypoints path = waypoints;
         for (int i = 0; i < cycleIteration; i++) {
-            for (const auto& waypoint : waypoints) {
-                this->moveToPosition(waypoint, wp_travelTime);
+            {
+                // Switch to a re-planned path only between two patrol cycles
+                std::lock_guard lock(pathMutex);
+                if (pendingPath) {
+                    path = *pendingPath;
+                    pendingPath.reset();
+                }
             }
+            {
+                // The whole cycle is planned at once, the drone wakes up at its end
+                std::lock_guard lock(positionMutex);
+                const double departure = clock.now();
+                this->trajectory.reset(this->trajectory.end());
+                for (const auto& waypoint : path)
+                    this->trajectory.addLeg(waypoint, departure, wp_travelTime);
+            }
+            this->followTrajectory();
         }
 
 
@@ -115,47 +136,27 @@ void Drone::receiveDestination(const Position destPoint, const int sleepTime,
     }
 }
 
-void Drone::moveToPosition(const Position& destination, float totalTravelTime) {
-
-    totalTravelTime /= timeScale;
-    // Record the start time
-    const auto startTime = std::chrono::steady_clock::now();
-    Position startPosition{};
+void Drone::moveToPosition(const Position& destination, const float totalTravelTime) {
     {
         std::lock_guard lock(positionMutex);
-        startPosition = this->position;
-    }
-
-    float elapsedTime = 0.0f;
-
-
-    Position newPosition{};
-    while (elapsedTime < totalTravelTime && this->state != DroneState::Offline) {
-        // Calculate the fraction of travel completed
-        const float fraction = elapsedTime / totalTravelTime;
-
-        // Interpolate the position
-        newPosition.x = startPosition.x + fraction * (destination.x - startPosition.x);
-        newPosition.y = startPosition.y + fraction * (destination.y - startPosition.y);
-
-        // Update the drone's position
-        {
-            std::lock_guard lock(positionMutex);
-            this->position = newPosition;
-        }
-
-        // Sleep for the update interval
-        std::this_thread::sleep_for(std::chrono::microseconds(1));
-
-        // Update the elapsed time
-        auto currentTime = std::chrono::steady_clock::now();
-        elapsedTime = std::chrono::duration<float>(currentTime - startTime).count();
+        this->trajectory.reset(this->trajectory.end());
+        this->trajectory.addLeg(destination, clock.now(), totalTravelTime);
     }
+    this->followTrajectory();
+}
 
-    // Ensure the final position is set exactly to the destination
+// Sleep until the drone reaches the end of its trajectory, or stop it where it is if it goes offline first
+void Drone::followTrajectory() {
+    double arrival;
     {
         std::lock_guard lock(positionMutex);
-        this->position = destination;
+        arrival = this->trajectory.arrival();
+    }
+
+    std::unique_lock lock(stateMutex);
+    if (stateChanged.wait_until(lock, clock.deadline(arrival), [this] { return this->state == DroneState::Offline; })) {
+        std::lock_guard positionLock(positionMutex);
+        this->trajectory.reset(this->trajectory.positionAt(clock.now()));
     }
 }
 
@@ -164,7 +165,7 @@ void Drone::consumption() {
     // Battery level should never be fall below 0%
     std::lock_guard lock(batteryMutex);
     {
-        this->batteryLevel = std::max(this->batteryLevel - consumptionRate * this->consumptionRatio, 0.0);
+        this->batteryLevel = consume(this->batteryLevel, this->consumptionRatio);
 
         // Out of charge check
         if (this->batteryLevel == 0.0) {
@@ -175,68 +176,108 @@ void Drone::consumption() {
 
 // Simulate drone recharge
 void Drone::recharge() {
-    const double rechargeTime = rechargeTimeMin + static_cast<double>(rand()) / RAND_MAX * (rechargeTimeMax - rechargeTimeMin);
+    const double rechargeTime = drawRechargeHours(std::uniform_real_distribution<double>(0.0, 1.0)(rng));
     const double rechargeRate = (100.0 - this->batteryLevel) / (rechargeTime * 3600.0);
 
-    while (this->batteryLevel < 100.0) {
-        const double rechargeAmount = rechargeRate * timeScale;
-        this->batteryLevel = std::min(this->batteryLevel + rechargeAmount, 100.0);
-        std::this_thread::sleep_for(std::chrono::duration<float>(1.0f));
+    // Charged a little every second by a timer, the drone thread only waits for the end
+    TimerWheel::shared().scheduleEvery(clock.deadline(clock.now() + 1.0), clock.duration(1.0), [this, rechargeRate]() {
+        {
+            std::lock_guard lock(batteryMutex);
+            this->batteryLevel = std::min(this->batteryLevel + rechargeRate, 100.0);
+            if (this->batteryLevel < 100.0)
+                return true;
+        }
+        this->changeState(DroneState::Ready);
+        return false;
+    });
+    {
+        std::unique_lock lock(stateMutex);
+        stateChanged.wait(lock, [this] { return this->state == DroneState::Ready; });
     }
-
-    this->state = DroneState::Ready;
     wait_for_path();
 }
 
 // Change drone state
 void Drone::changeState(const DroneState::Enum newState) {
-    this->state = newState;
+    {
+        std::lock_guard lock(stateMutex);
+        this->state = newState;
+        // A drone that went down cannot call its successor anymore
+        if (newState == DroneState::Offline && handoffTimer != 0)
+            TimerWheel::shared().cancel(handoffTimer);
+    }
+    stateChanged.notify_all();
 }
 
 void Drone::changeConsumptionRatio(const double ratio) {
     this->consumptionRatio = ratio;
 }
 
-void Drone::statusUpdateThread() {
-    // Send status update to the tower
-    std::this_thread::sleep_for(std::chrono::duration<float>(0.5));
-    while (this->state != DroneState::Offline) {
-        // Create a json object with the drone status
-        nlohmann::json status = {
-            {"drone_id", this->ID},
-            {"position", ~this->position},
-            {"battery_level", std::floor(this->batteryLevel * 100.0) / 100.0},
-            {"state", DroneState::toString(this->state)},
-            {"timestamp", std::chrono::system_clock::now().time_since_epoch().count()}
-        };
-
-        // Send the status update
-        this->redisClient.send_status_update(status);
-
-        // Wait for 3 seconds before the next update
-        std::this_thread::sleep_for(std::chrono::duration<float>(1.0 / timeScale));
-    }
+void Drone::startStatusUpdates() {
+    // Send status update to the tower every second, until the drone goes offline. The timer only takes the sample, the
+    // sender pool writes it to Redis
+    TimerWheel::shared().scheduleEvery(clock.deadline(clock.now() + 0.5 * timeScale), clock.duration(1.0), [this]() {
+        const DroneState::Enum current = this->state;
+        if (current == DroneState::Offline)
+            return false;
+        const Status status = makeStatus(this->ID, current, this->getPosition(), this->batteryLevel, this->clock.wallTime(this->clock.now()));
+        SenderPool::shared().post(static_cast<std::size_t>(this->ID), [this, status]() { this->redisClient.send_status_update(status); });
+        return true;
+    });
 }
 
-// Drone's battery thread implementation
-void Drone::batteryUpdateThread() {
-    while (this->state != DroneState::Offline && this->state != DroneState::Charging && this->state != DroneState::Ready) {
-        // Battery consumption
-        this->consumption();
+// Drone's path update thread implementation
+void Drone::pathUpdateThread() {
+    redisClient.listen_for_path_updates([this](const Sector::Waypoints& path) {
+        std::lock_guard lock(pathMutex);
+        this->pendingPath = path;
+    });
+}
 
-        // Wait a secondo before the next consumption
-        std::this_thread::sleep_for(std::chrono::duration<float>(1.0 / timeScale));
-    }
+// Battery consumption every second while the drone is away from the tower, until it goes offline
+void Drone::startBatteryUpdates() {
+    TimerWheel::shared().scheduleEvery(clock.deadline(clock.now() + 1.0), clock.duration(1.0), [this]() {
+        const DroneState::Enum current = this->state;
+        if (current == DroneState::Offline)
+            return false;
+        if (current != DroneState::Charging && current != DroneState::Ready)
+            this->consumption();
+        return true;
+    });
+}
+
+double Drone::consume(const double batteryLevel, const double ratio) {
+    return std::max(batteryLevel - consumptionRate * ratio, 0.0);
+}
+
+double Drone::drawRechargeHours(const double u) {
+    return rechargeTimeMin + u * (rechargeTimeMax - rechargeTimeMin);
+}
+
+float Drone::travelTime(const Position from, const Position to) {
+    return utils::calculateTime(utils::calculateDistance(from, to), speed);
+}
+
+Status Drone::makeStatus(const int id, const DroneState::Enum state, const Position position, const double batteryLevel,
+                         const std::chrono::system_clock::time_point time) {
+    Status status;
+    status.droneID = id;
+    status.state = state;
+    status.position = ~position;
+    status.batteryLevel = std::floor(batteryLevel * 100.0) / 100.0;
+    status.timestamp = time;
+    return status;
 }
 
 int Drone::getCycleIteration(const int sleepTime) {
-    constexpr int cycleTime = 240;
+    constexpr int cycleTime = Sector::Geometry::cycleTime;
     return sleepTime / cycleTime;
 }
 
 // Get current drone position
 Position Drone::getPosition() const {
-    return this->position;
+    std::lock_guard lock(positionMutex);
+    return this->trajectory.positionAt(clock.now());
 }
 
 // Get current battery level
@@ -5,25 +5,38 @@
 #include "thread"
 #include "chrono"
 #include "cmath"
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <optional>
 #include "Utils/Structs.h"
 #include "Utils/Redis.h"
+#include "Utils/Trajectory.h"
+#include "Utils/Clock.h"
+#include "Utils/Random.h"
 #include "Utils/utils.h"
 
 
 class Drone {
 private:
-    Position position;                              // Current position
-    std::mutex positionMutex;                       // Mutex for position
+    Trajectory trajectory;                          // Current flight plan, the position is computed from it
+    mutable std::mutex positionMutex;               // Mutex for trajectory
     std::mutex batteryMutex;                        // Mutex for battery
     Position towerPosition;                         // Tower position
-    DroneState::Enum state;                         // Current drone state
+    std::atomic<DroneState::Enum> state;            // Current drone state, read by the timers without locking
+    std::mutex stateMutex;                          // Serializes state changes, for stateChanged
+    std::condition_variable stateChanged;           // Wakes a flying drone that goes offline
+    RealClock clock;                                // Mission clock, every wait goes through it
+    std::mt19937_64 rng;                            // Generator for the recharge times, keyed by ID once connected
+    TimerWheel::TimerID handoffTimer = 0;           // Pending go_next, revoked if the drone goes offline
     DroneClient redisClient;                        // Redis client
+    std::mutex pathMutex;                           // Mutex for pendingPath
+    std::optional<Sector::Waypoints> pendingPath;   // Re-planned path, flown from the next patrol cycle
 
     int ID;                                 // Drone's ID (assigned once connected to the tower)
     int timeScale;                          // Time scale for the simulation
-    double batteryLevel;                    // Current battery level
-    double  consumptionRatio;               // Drone's battery consumption rate
+    std::atomic<double> batteryLevel;       // Current battery level, updated under batteryMutex
+    std::atomic<double> consumptionRatio;   // Drone's battery consumption rate
     static const double consumptionRate;    // batteryConsumption/s
     static const double speed;              // Speed in m/s
     static const double flightAutonomy;     // Flight autonomy in minutes
@@ -32,7 +45,9 @@ private:
     static const double visibilityRange;    // Visibility range in meters
 
 public:
-    explicit Drone(int timeScale = 1);    // Drone constructor
+    explicit Drone(const std::shared_ptr<DroneMultiplexer> &multiplexer,                    // Drone constructor
+                   int timeScale = 1, wire::Encoding encoding = wire::Encoding::Binary, const StatusLogOptions &statusLog = {},
+                   bool pushStatus = false);
     void wait_for_path();
 
     // Drone function
@@ -43,18 +58,29 @@ public:
 
     void move(Position dest, float travelTime);                               // Move toward dest
     void receiveDestination(Position destPoint, int sleepTime,               // Receive new destination
-                            const std::array<Position, 100>& waypoints, bool init);
+                            const Sector::Waypoints& waypoints, bool init);
     void moveToPosition(const Position& destination, float totalTravelTime);
+    void followTrajectory();                                               // Wait until the end of the flight plan
+
+    // Periodic timers
+    void startBatteryUpdates();                                             // Battery consumption every second
+    void startStatusUpdates();                                             // Update drone's status on redis every second
 
     // Threads
-    void batteryUpdateThread();                                             // Update drone's battery on redis
-    void statusUpdateThread();                                             // Update drone's status on redis
+    void pathUpdateThread();                                              // Receive re-planned paths from the tower
 
     [[nodiscard]] Position getPosition() const;
     [[nodiscard]] Position getDestination() const;
     [[nodiscard]] DroneState::Enum getDroneState() const;
 
-    [[nodiscard]] int getCycleIteration(int sleepTime);
+    // Battery and flight model, shared with the fleet simulator
+    [[nodiscard]] static double consume(double batteryLevel, double ratio);        // Battery level after one second at ratio
+    [[nodiscard]] static double drawRechargeHours(double u);                      // Recharge time for u uniform in [0, 1]
+    [[nodiscard]] static float travelTime(Position from, Position to);           // Flight time in seconds
+    [[nodiscard]] static int getCycleIteration(int sleepTime);                  // Patrol cycles flown in sleepTime seconds
+    [[nodiscard]] static Status makeStatus(int id, DroneState::Enum state,     // Status as reported to the tower
+                                           Position position, double batteryLevel,
+                                           std::chrono::system_clock::time_point time);
     [[nodiscard]] double getBatteryLevel() const;
     [[nodiscard]] int getID() const;
 
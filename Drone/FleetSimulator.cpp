@@ -0,0 +1,405 @@
+#include "FleetSimulator.h"
+
+
+FleetSimulator::FleetSimulator(const std::shared_ptr<DroneMultiplexer> &multiplexer, const int droneCount, const int timeScale,
+                               const SimulationOptions &options)
+    : multiplexer(multiplexer), redis(multiplexer->get_redis_instance()), timeScale(timeScale), options(options), realClock(timeScale), virtualClock(timeScale),
+      clock(options.virtualTime ? static_cast<Clock &>(virtualClock) : realClock), droneCount(droneCount) {
+    unsigned shardCount = options.shards ? options.shards : std::max(1u, std::thread::hardware_concurrency());
+    if (options.virtualTime)
+        shardCount = 1;     // A single event queue keeps the order of the events fixed
+    shardCount = std::min(shardCount, static_cast<unsigned>(std::max(droneCount, 1)));
+
+    for (unsigned s = 0; s < shardCount; s++)
+        shards.push_back(std::make_unique<Shard>());
+    for (int i = 0; i < droneCount; i++) {
+        Shard &shard = *shards[i % shardCount];
+        DroneClient client(redis, timeScale, options.encoding);
+        client.set_status_echo(false);
+        client.set_status_log(options.statusLog);
+        client.set_status_push(options.pushStatus);
+        shard.drones.emplace_back(std::move(client));
+    }
+}
+
+void FleetSimulator::run() {
+    for (int s = 0; s < static_cast<int>(shards.size()); s++)
+        for (int i = 0; i < static_cast<int>(shards[s]->drones.size()); i++)
+            listenToTower(s, i);
+    multiplexer->subscribe("drone:broadcast", [this](const std::string &) {
+        for (int s = 0; s < static_cast<int>(shards.size()); s++)
+            deliver(s, Message{Message::Broadcast});
+    });
+
+    running = true;
+    const double start = clock.now();
+    for (auto &shard : shards) {
+        for (int i = 0; i < static_cast<int>(shard->drones.size()); i++)
+            schedule(*shard, start, i, EventType::Handshake);
+        shard->thread = std::thread(options.virtualTime ? &FleetSimulator::runVirtual : &FleetSimulator::runShard, this, std::ref(*shard));
+    }
+    std::cout << "Simulating " << droneCount << " drones on " << shards.size() << " threads"
+              << (options.virtualTime ? " in virtual time" : "") << std::endl;
+
+    multiplexer->wait_until_closed();
+    running = false;
+    for (auto &shard : shards) {
+        {
+            std::lock_guard lock(shard->inboxMutex);
+        }
+        shard->inboxCondition.notify_one();
+        shard->thread.join();
+    }
+}
+
+// Route the tower's messages for a drone to its shard: the initialization by UUID, then commands and path updates by
+// the drone ID it assigns
+void FleetSimulator::listenToTower(const int shard, const int index) {
+    const std::string uuid = shards[shard]->drones[index].client.get_uuid();
+    const std::string channel = "drone:" + uuid + ":init";
+    const auto token = std::make_shared<uint64_t>();
+    *token = multiplexer->subscribe(channel, [this, shard, index, channel, token](const std::string &payload) {
+        onInit(shard, index, payload);
+        multiplexer->unsubscribe(channel, *token);
+    });
+}
+
+void FleetSimulator::onInit(const int shard, const int index, const std::string &payload) {
+    auto init = wire::decodeInit(payload);
+    if (!init) {
+        std::cerr << "Invalid initialization message" << std::endl;
+        return;
+    }
+    const std::string prefix = "drone:" + std::to_string(init->droneID);
+    multiplexer->subscribe(prefix + ":commands", [this, shard, index](const std::string &payload) {
+        auto command = wire::decodeCommand(payload);
+        if (!command) {
+            std::cerr << "Invalid command message" << std::endl;
+            return;
+        }
+        Message message{Message::Command, index};
+        message.assignment = std::move(*command);
+        deliver(shard, std::move(message));
+    });
+    multiplexer->subscribe(prefix + ":path", [this, shard, index](const std::string &payload) {
+        const auto path = wire::decodePath(payload);
+        if (!path) {
+            std::cerr << "Invalid path message" << std::endl;
+            return;
+        }
+        Message message{Message::Path, index};
+        message.path = *path;
+        deliver(shard, std::move(message));
+    });
+
+    Message message{Message::Init, index};
+    message.init = std::move(*init);
+    deliver(shard, std::move(message));
+}
+
+void FleetSimulator::deliver(const int shard, Message message) {
+    Shard &target = *shards[shard];
+    {
+        std::lock_guard lock(target.inboxMutex);
+        target.inbox.push_back(std::move(message));
+    }
+    target.inboxCondition.notify_one();
+}
+
+// Process the events of a shard in time order, sleeping until the next one is due or a message arrives
+void FleetSimulator::runShard(Shard &shard) {
+    std::deque<Message> messages;
+    while (running) {
+        {
+            std::unique_lock lock(shard.inboxMutex);
+            const auto woken = [&shard, this] { return !shard.inbox.empty() || !running; };
+            if (shard.events.empty())
+                shard.inboxCondition.wait(lock, woken);
+            else
+                shard.inboxCondition.wait_until(lock, realClock.deadline(shard.events.top().time), woken);
+            messages.swap(shard.inbox);
+        }
+
+        try {
+            const double now = clock.now();
+            for (auto &message : messages)
+                handleMessage(shard, message, now);
+            messages.clear();
+
+            while (!shard.events.empty() && shard.events.top().time <= now) {
+                const Event event = shard.events.top();
+                shard.events.pop();
+                handleEvent(shard, event);
+            }
+        } catch (const Error &err) {
+            std::cerr << "Error sending drone messages: " << err.what() << std::endl;
+            messages.clear();
+        }
+    }
+}
+
+// Virtual time: run the events back to back, but let the tower answer the messages expecting a reply (handshakes,
+// go_next) before the clock moves past them. Statuses get no reply: the START broadcast the tower sends once every
+// drone reports Waiting is picked up from the inbox between two events
+void FleetSimulator::runVirtual(Shard &shard) {
+    std::deque<Message> messages;
+    const auto settle = std::chrono::milliseconds(options.settleMilliseconds);
+    while (running) {
+        {
+            std::unique_lock lock(shard.inboxMutex);
+            const auto woken = [&shard, this] { return !shard.inbox.empty() || !running; };
+            if (shard.events.empty())
+                shard.inboxCondition.wait(lock, woken);
+            else if (shard.awaitingTower && !shard.inboxCondition.wait_for(lock, settle, woken))
+                shard.awaitingTower = false;    // The tower has nothing more to say
+            messages.swap(shard.inbox);
+        }
+
+        try {
+            if (!messages.empty()) {
+                for (auto &message : messages)
+                    handleMessage(shard, message, clock.now());
+                messages.clear();
+                continue;   // Answers may come in several batches
+            }
+            if (shard.awaitingTower || shard.events.empty())
+                continue;
+
+            const Event event = shard.events.top();
+            shard.events.pop();
+            clock.sleepUntil(event.time);
+            handleEvent(shard, event);
+        } catch (const Error &err) {
+            std::cerr << "Error sending drone messages: " << err.what() << std::endl;
+            messages.clear();
+        }
+    }
+}
+
+void FleetSimulator::schedule(Shard &shard, const double time, const int drone, const EventType type, const uint32_t generation) {
+    shard.events.push({time, shard.sequence++, drone, type, generation});
+}
+
+void FleetSimulator::handleEvent(Shard &shard, const Event &event) {
+    SimulatedDrone &drone = shard.drones[event.drone];
+    const double time = event.time;
+
+    switch (event.type) {
+        case EventType::Handshake:
+            drone.client.send_handshake();
+            shard.awaitingTower = true;
+            break;
+
+        case EventType::Status:
+            if (drone.state == DroneState::Offline)
+                break;
+            drone.client.send_status_update(Drone::makeStatus(drone.client.get_drone_id(), drone.state, drone.trajectory.positionAt(time),
+                                                              batteryAt(drone, time), clock.wallTime(time)));
+            schedule(shard, time + 1, event.drone, EventType::Status);
+            break;
+
+        case EventType::Battery:
+            // Drains while the drone is away from the tower, as in Drone::batteryUpdateThread
+            if (drone.state == DroneState::Offline || drone.state == DroneState::Charging || drone.state == DroneState::Ready) {
+                drone.batteryTicking = false;
+                break;
+            }
+            drone.batteryLevel = Drone::consume(drone.batteryLevel, drone.consumptionRatio);
+            if (drone.batteryLevel == 0.0) {
+                drone.trajectory.reset(drone.trajectory.positionAt(time));
+                drone.generation++;
+                drone.handoff++;
+                drone.phase = Phase::Offline;
+                changeState(shard, event.drone, DroneState::Offline, time);
+                drone.batteryTicking = false;
+                break;
+            }
+            schedule(shard, time + 1, event.drone, EventType::Battery);
+            break;
+
+        case EventType::Step:
+            if (event.generation != drone.generation)
+                break;
+            switch (drone.phase) {
+                case Phase::InitDelay:
+                    drone.phase = Phase::Arriving;
+                    changeState(shard, event.drone, DroneState::Arriving, time);
+                    startLeg(shard, event.drone, drone.startingPoint, drone.travelTime, time);
+                    break;
+                case Phase::Arriving:
+                    if (drone.init) {
+                        drone.phase = Phase::Waiting;
+                        changeState(shard, event.drone, DroneState::Waiting, time);
+                        drone.consumptionRatio = 0.0;
+                    } else {
+                        startMonitoring(shard, event.drone, time);
+                    }
+                    break;
+                case Phase::Monitoring:
+                    drone.cycle++;
+                    startPatrolCycle(shard, event.drone, time);
+                    break;
+                case Phase::Returning:
+                    startCharging(shard, event.drone, time);
+                    break;
+                case Phase::Charging:
+                    drone.batteryLevel = 100.0;
+                    drone.phase = Phase::Ready;
+                    changeState(shard, event.drone, DroneState::Ready, time);
+                    break;
+                default:
+                    break;
+            }
+            break;
+
+        case EventType::GoNext:
+            if (event.generation != drone.handoff || drone.phase == Phase::Offline)
+                break;
+            drone.client.send_go_next();
+            shard.awaitingTower = true;
+            break;
+    }
+}
+
+void FleetSimulator::handleMessage(Shard &shard, Message &message, const double time) {
+    if (message.kind == Message::Broadcast) {
+        // Start every drone waiting on its starting point
+        for (int i = 0; i < static_cast<int>(shard.drones.size()); i++) {
+            if (shard.drones[i].phase == Phase::Waiting) {
+                shard.drones[i].consumptionRatio = 1.0;
+                startMonitoring(shard, i, time);
+            }
+        }
+        return;
+    }
+
+    // Paths are resolved here, on the shard, rather than on the multiplexer thread every drone's messages go through:
+    // fetching a tour seen for the first time is a blocking GET
+    const auto resolve = [this](wire::PathRef &path) { return (path.tsp = DroneClient::resolve_path(*redis, path)).has_value(); };
+
+    SimulatedDrone &drone = shard.drones[message.drone];
+    switch (message.kind) {
+        case Message::Init:
+            if (drone.phase != Phase::Connecting)
+                break;
+            // Without its path the assignment is dropped, the drone then waits for a command
+            if (message.init.assignment && !resolve(message.init.assignment->path))
+                message.init.assignment.reset();
+            drone.client.set_drone_id(message.init.droneID);
+            drone.rng = Random::generator(static_cast<uint64_t>(message.init.droneID));
+            drone.towerPosition = message.init.towerPosition;
+            drone.trajectory.reset(drone.towerPosition);
+            drone.phase = Phase::Ready;
+            schedule(shard, time + 0.5 * timeScale, message.drone, EventType::Status);
+            if (message.init.assignment)
+                startAssignment(shard, message.drone, *message.init.assignment, true, time);
+            break;
+
+        case Message::Command:
+            // A drone listens for commands only once it is ready again
+            if (drone.phase == Phase::Ready && resolve(message.assignment.path))
+                startAssignment(shard, message.drone, message.assignment, false, time);
+            break;
+
+        case Message::Path:
+            // Flown from the next patrol cycle
+            if (drone.phase != Phase::Connecting && resolve(message.path))
+                drone.pendingPath = message.path.tsp;
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Same sequence as Drone::receiveDestination
+void FleetSimulator::startAssignment(Shard &shard, const int index, const wire::Assignment &assignment, const bool init, const double time) {
+    SimulatedDrone &drone = shard.drones[index];
+    drone.pendingPath.reset();
+    drone.init = init;
+    drone.startingPoint = assignment.path.startingPoint;
+    drone.timer = assignment.timer;
+    drone.path = *assignment.path.tsp;
+    drone.travelTime = Drone::travelTime(drone.trajectory.end(), drone.startingPoint);
+
+    if (init) {
+        // The initial assignment starts after a 6 seconds delay
+        drone.phase = Phase::InitDelay;
+        schedule(shard, time + 6.0 * timeScale, index, EventType::Step, ++drone.generation);
+    } else {
+        drone.phase = Phase::Arriving;
+        changeState(shard, index, DroneState::Arriving, time);
+        startLeg(shard, index, drone.startingPoint, drone.travelTime, time);
+    }
+}
+
+void FleetSimulator::startLeg(Shard &shard, const int index, const Position destination, const float travelTime, const double time) {
+    SimulatedDrone &drone = shard.drones[index];
+    drone.trajectory.reset(drone.trajectory.end());
+    const double arrival = drone.trajectory.addLeg(destination, time, travelTime);
+    schedule(shard, arrival, index, EventType::Step, ++drone.generation);
+}
+
+void FleetSimulator::startMonitoring(Shard &shard, const int index, const double time) {
+    SimulatedDrone &drone = shard.drones[index];
+    // The next drone is called when this one has to leave to be back on time
+    schedule(shard, time + std::max(drone.timer - drone.travelTime, 0.0f), index, EventType::GoNext, ++drone.handoff);
+
+    drone.phase = Phase::Monitoring;
+    changeState(shard, index, DroneState::Monitoring, time);
+    drone.cycleIteration = Drone::getCycleIteration(drone.timer);
+    drone.waypointTravelTime = drone.path.size() > 1 ? Drone::travelTime(drone.path[0], drone.path[1]) : 0.0f;
+    drone.cycle = 0;
+    startPatrolCycle(shard, index, time);
+}
+
+// Plan a whole patrol cycle, the drone is only stepped again at its end
+void FleetSimulator::startPatrolCycle(Shard &shard, const int index, const double time) {
+    SimulatedDrone &drone = shard.drones[index];
+    if (drone.cycle >= drone.cycleIteration || drone.path.empty()) {
+        drone.phase = Phase::Returning;
+        changeState(shard, index, DroneState::Returning, time);
+        startLeg(shard, index, drone.towerPosition, drone.travelTime, time);
+        return;
+    }
+
+    // Switch to a re-planned path only between two patrol cycles
+    if (drone.pendingPath) {
+        drone.path = *drone.pendingPath;
+        drone.pendingPath.reset();
+    }
+    drone.trajectory.reset(drone.trajectory.end());
+    for (const auto &waypoint : drone.path)
+        drone.trajectory.addLeg(waypoint, time, drone.waypointTravelTime);
+    schedule(shard, drone.trajectory.arrival(), index, EventType::Step, ++drone.generation);
+}
+
+void FleetSimulator::startCharging(Shard &shard, const int index, const double time) {
+    SimulatedDrone &drone = shard.drones[index];
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    const double rechargeTime = Drone::drawRechargeHours(uniform(drone.rng)) * 3600.0;
+
+    drone.phase = Phase::Charging;
+    changeState(shard, index, DroneState::Charging, time);
+    drone.chargeStart = time;
+    drone.chargeLevel = drone.batteryLevel;
+    drone.chargeRate = (100.0 - drone.batteryLevel) / rechargeTime;
+    schedule(shard, time + rechargeTime, index, EventType::Step, ++drone.generation);
+}
+
+void FleetSimulator::changeState(Shard &shard, const int index, const DroneState::Enum state, const double time) {
+    SimulatedDrone &drone = shard.drones[index];
+    drone.state = state;
+    const bool flying = state == DroneState::Arriving || state == DroneState::Waiting ||
+                        state == DroneState::Monitoring || state == DroneState::Returning;
+    if (flying && !drone.batteryTicking) {
+        drone.batteryTicking = true;
+        schedule(shard, time + 1, index, EventType::Battery);
+    }
+}
+
+double FleetSimulator::batteryAt(const SimulatedDrone &drone, const double time) {
+    if (drone.phase != Phase::Charging)
+        return drone.batteryLevel;
+    return std::min(drone.chargeLevel + drone.chargeRate * (time - drone.chargeStart), 100.0);
+}
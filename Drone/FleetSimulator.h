@@ -0,0 +1,146 @@
+#ifndef SKYWATCHER_FLEETSIMULATOR_H
+#define SKYWATCHER_FLEETSIMULATOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <queue>
+#include "Drone/Drone.h"
+#include "Utils/Trajectory.h"
+#include "Utils/Clock.h"
+#include "Utils/Random.h"
+
+
+struct SimulationOptions {
+    wire::Encoding encoding = wire::Encoding::Binary;
+    unsigned shards = 0;            // Threads driving the drones, one per core if 0
+    bool virtualTime = false;       // Skip the time between events, on a single thread
+    int settleMilliseconds = 50;    // Virtual time: silence of the tower after which the clock moves on
+    bool pushStatus = false;        // Also publish statuses on drone:status, for an event-driven tower
+    StatusLogOptions statusLog;
+};
+
+// Simulates a whole fleet from a few threads instead of several threads per drone.
+// The drones are split across shards; each shard thread owns its drones and a queue of timed events (status updates,
+// battery ticks, end of a flight plan...) processed in mission time order. The tower's messages arrive through the
+// process-wide DroneMultiplexer and are handed to the owning shard. Drones follow the state machine and battery model of
+// Drone and produce the same Redis traffic.
+// With virtual time the events run back to back on one shard, in a fixed order, and the clock only waits for the
+// tower to answer the messages that expect a reply
+class FleetSimulator {
+public:
+    FleetSimulator(const std::shared_ptr<DroneMultiplexer> &multiplexer, int droneCount, int timeScale, const SimulationOptions &options = {});
+
+    // Connect every drone to the tower and simulate until the Redis connection fails
+    void run();
+
+private:
+    enum class EventType : uint8_t {
+        Handshake,  // Register with the tower
+        Status,     // Send a status update, every mission second
+        Battery,    // Battery consumption, every mission second while flying
+        Step,       // End of the current flight plan or delay
+        GoNext      // Ask the tower for the next drone of the sector
+    };
+
+    struct Event {
+        double time;            // Mission time in seconds
+        uint64_t sequence;      // Events due at the same time run in scheduling order
+        int drone;              // Index in the shard
+        EventType type;
+        uint32_t generation;    // Step events of a flight plan that was abandoned are dropped, as are GoNext events of a
+                                // handoff that was cancelled (see SimulatedDrone::handoff)
+
+        bool operator>(const Event &other) const {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+
+    // Message from the tower, decoded by the subscriber
+    struct Message {
+        enum Kind : uint8_t { Init, Command, Path, Broadcast } kind;
+        int drone = -1;                 // Index in the shard, unused for broadcasts
+        wire::InitMessage init{};       // Init
+        wire::Assignment assignment{};  // Command
+        wire::PathRef path{};           // Path
+    };
+
+    // Where the drone is in Drone::receiveDestination
+    enum class Phase : uint8_t { Connecting, Ready, InitDelay, Arriving, Waiting, Monitoring, Returning, Charging, Offline };
+
+    struct SimulatedDrone {
+        DroneClient client;
+        DroneState::Enum state = DroneState::Ready;
+        Phase phase = Phase::Connecting;
+        double batteryLevel = 100.0;
+        double consumptionRatio = 1.0;
+        bool batteryTicking = false;
+        Position towerPosition{0, 0};
+        Trajectory trajectory;          // Current flight plan, the position is computed from it
+        uint32_t generation = 0;
+        uint32_t handoff = 0;           // Bumped when a pending GoNext no longer applies, like Drone::handoffTimer being cancelled
+        std::mt19937_64 rng;            // Keyed by the drone ID on init, as in Drone
+
+        // Current assignment
+        bool init = false;
+        Position startingPoint{0, 0};
+        int timer = 0;
+        float travelTime = 0;           // From the tower to the starting point
+        float waypointTravelTime = 0;
+        Sector::Waypoints path{};
+        std::optional<Sector::Waypoints> pendingPath;
+        int cycle = 0, cycleIteration = 0;
+
+        // Recharge
+        double chargeStart = 0, chargeLevel = 0, chargeRate = 0;
+
+        explicit SimulatedDrone(DroneClient client) : client(std::move(client)) {}
+    };
+
+    struct Shard {
+        std::vector<SimulatedDrone> drones;
+        std::priority_queue<Event, std::vector<Event>, std::greater<>> events;
+        uint64_t sequence = 0;
+        bool awaitingTower = false;     // A message expecting a reply was sent at the current virtual time
+
+        std::mutex inboxMutex;
+        std::condition_variable inboxCondition;
+        std::deque<Message> inbox;
+        std::thread thread;
+    };
+
+    std::shared_ptr<DroneMultiplexer> multiplexer;
+    std::shared_ptr<Redis> redis;
+    int timeScale;
+    SimulationOptions options;
+    RealClock realClock;
+    VirtualClock virtualClock;
+    Clock &clock;
+    std::vector<std::unique_ptr<Shard>> shards;
+    int droneCount;
+    std::atomic<bool> running{false};
+
+    // Subscriber thread of the multiplexer
+    void listenToTower(int shard, int index);
+    void onInit(int shard, int index, const std::string &payload);
+    void deliver(int shard, Message message);
+
+    // Shards
+    void runShard(Shard &shard);
+    void runVirtual(Shard &shard);
+    static void schedule(Shard &shard, double time, int drone, EventType type, uint32_t generation = 0);
+    void handleEvent(Shard &shard, const Event &event);
+    void handleMessage(Shard &shard, Message &message, double time);
+
+    // State machine of a drone
+    void startAssignment(Shard &shard, int index, const wire::Assignment &assignment, bool init, double time);
+    void startLeg(Shard &shard, int index, Position destination, float travelTime, double time);
+    void startMonitoring(Shard &shard, int index, double time);
+    void startPatrolCycle(Shard &shard, int index, double time);
+    void startCharging(Shard &shard, int index, double time);
+    void changeState(Shard &shard, int index, DroneState::Enum state, double time);
+    [[nodiscard]] static double batteryAt(const SimulatedDrone &drone, double time);
+};
+
+
+#endif //SKYWATCHER_FLEETSIMULATOR_H
@@ -1,29 +1,73 @@
 #include "Drone/Drone.h"
+#include "Drone/FleetSimulator.h"
+#include "Utils/CommandLine.h"
 
 
 int main(const int argc, char* argv[]) {
     // Get command line arguments
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " [timeScale]" << std::endl;
+    const CommandLine commandLine(argc, argv);
+    if (commandLine.positional().size() != 1) {
+        std::cerr << "Usage: " << argv[0] << " [timeScale] [--json] [--seed=S] [--simulate] [--drones=N] [--shards=K] [--virtual] [--settle=ms] [--connections=N] [--push] [--cell-events] [--log-maxlen=N]" << std::endl;
         return 1;
     }
-    const int timeScale = std::stoi(argv[1]);
+    const int timeScale = std::stoi(commandLine.positional()[0]);
+    // --json: send statuses as JSON instead of the binary wire format, for debugging
+    const wire::Encoding encoding = commandLine.has("json") ? wire::Encoding::Json : wire::Encoding::Binary;
+    // --drones=N: number of drones to start
+    const int droneCount = std::stoi(commandLine.value("drones", "288"));
     if (timeScale <= 0) {
         std::cerr << "Invalid time scale. Please provide a positive integer." << std::endl;
         return 1;
     }
+    if (droneCount <= 0) {
+        std::cerr << "Invalid number of drones. Please provide a positive integer." << std::endl;
+        return 1;
+    }
+    // --seed=S: repeatable random draws (recharge times)
+    if (commandLine.has("seed"))
+        Random::seed(std::stoull(commandLine.value("seed", "0")));
+
+    // --push: also publish every status on drone:status, for a tower started with --events
+    const bool pushStatus = commandLine.has("push");
+
+    // --cell-events: log only the cells entered while monitoring to status_logs, instead of every status.
+    // --log-maxlen=N: trim status_logs to about N entries (1000000 by default with --cell-events, 0 for no limit)
+    StatusLogOptions statusLog;
+    statusLog.cellEvents = commandLine.has("cell-events");
+    statusLog.maxLength = std::stoull(commandLine.value("log-maxlen", statusLog.cellEvents ? "1000000" : "0"));
+
+    // --simulate: run every drone from a few event-driven threads, --shards=K sets the number of threads.
+    // --virtual: skip the time between events on a single thread, waiting at most --settle=ms for the tower's answers
+    const bool simulate = commandLine.has("simulate");
+    SimulationOptions options;
+    options.encoding = encoding;
+    options.shards = std::stoul(commandLine.value("shards", "0"));
+    options.virtualTime = commandLine.has("virtual");
+    options.settleMilliseconds = std::stoi(commandLine.value("settle", std::to_string(options.settleMilliseconds)));
+    options.pushStatus = pushStatus;
+    options.statusLog = statusLog;
+
+    // Every drone of the process shares the connection pool and the subscriber connection.
+    // --connections=N: size of the pool, by default one per simulator thread or 16 for threaded drones
+    const unsigned workers = options.virtualTime ? 1 : options.shards ? options.shards : std::thread::hardware_concurrency();
+    const unsigned connections = std::stoul(commandLine.value("connections", std::to_string(simulate ? workers : 16)));
+    const auto multiplexer = DroneMultiplexer::create("127.0.0.1", 6379, std::max(connections, 1u));
+
+    if (simulate) {
+        FleetSimulator simulator(multiplexer, droneCount, timeScale, options);
+        simulator.run();
+        return 0;
+    }
+
     // Initialize a drone
     std::vector<std::thread> threads;
-    for(int i = 0; i < 36*8; i++) {
-        threads.emplace_back([&timeScale]() {
-            if(timeScale)
-                Drone drone(timeScale);
-            else
-                Drone drone;
+    for(int i = 0; i < droneCount; i++) {
+        threads.emplace_back([&multiplexer, &timeScale, &encoding, &statusLog, pushStatus]() {
+            Drone drone(multiplexer, timeScale, encoding, statusLog, pushStatus);
         });
     }
     for(auto& thread : threads) {
         thread.join();
     }
     return 0;
-}
\ No newline at end of file
+}
@@ -1,194 +1,344 @@
 #include <iostream>
 #include <vector>
-#include <map>
 #include <chrono>
 #include <algorithm>
 #include <iomanip>    // For std::get_time
 #include <sstream>    // For std::istringstream
+#include <thread>
 #include "Utils/Redis.h"
+#include "Utils/CommandLine.h"
+#include "RevisitTracker.h"
+#include "StatusLog.h"
 
 
 using namespace sw::redis;
 
-// Function to retrieve status logs from Redis
-void retrieve_status_logs_from_redis(std::shared_ptr<Redis> redis,
-                                     std::vector<nlohmann::json> &status_logs,
-                                     std::chrono::system_clock::time_point &simulation_start_time,
-                                     std::chrono::system_clock::time_point &simulation_end_time) {
-    std::string stream_key = "status_logs";
-
-    // Fetch all entries from the stream
-    // Prepare the vector to hold entries
-    std::vector<std::pair<std::string, std::unordered_map<std::string, std::string>>> entries;
-
-    // Fetch all entries from the stream
-    redis->xrange(stream_key, "-", "+", std::back_inserter(entries));
-
-
-    if (entries.empty()) {
-        std::cerr << "No entries found in the status_logs stream." << std::endl;
-        logError("Monitor", "No entries found in the status_logs stream.");
-        return;
-    }
-
-    simulation_start_time = std::chrono::system_clock::time_point::min();
-    simulation_end_time = std::chrono::system_clock::time_point::min();
-
-    for (const auto &entry : entries) {
-        auto status_iter = entry.second.find("status");
-        if (status_iter != entry.second.end()) {
-            nlohmann::json status = nlohmann::json::parse(status_iter->second);
-
-            // Parse timestamp
-            std::string timestamp_str = status["timestamp"];
-            std::tm tm = {};
-            std::istringstream ss(timestamp_str);
-            ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-            if (ss.fail()) {
-                std::cerr << "Failed to parse timestamp: " << timestamp_str << std::endl;
-                logError("Monitor", "Failed to parse timestamp: " + timestamp_str);
-                continue;
-            }
-            std::time_t time_t_timestamp = std::mktime(&tm);
-            std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::from_time_t(time_t_timestamp);
-
-            // Update simulation start and end times
-            if (simulation_start_time == std::chrono::system_clock::time_point::min() || timestamp < simulation_start_time) {
-                simulation_start_time = timestamp;
-            }
-            if (simulation_end_time == std::chrono::system_clock::time_point::min() || timestamp > simulation_end_time) {
-                simulation_end_time = timestamp;
-            }
-
-            // Add status to status_logs
-            status_logs.push_back(status);
-        }
-    }
-}
-
-// Helper function to format time points
+// Helper function to format time points, called from the report threads: std::localtime shares one buffer
 std::string format_time_point(const std::chrono::system_clock::time_point &time_point) {
     std::time_t time_t_timestamp = std::chrono::system_clock::to_time_t(time_point);
-    std::tm tm = *std::localtime(&time_t_timestamp);
+    std::tm tm{};
+#if defined(_WIN32) || defined(_WIN64)
+    localtime_s(&tm, &time_t_timestamp);
+#else
+    localtime_r(&time_t_timestamp, &tm);
+#endif
     char buffer[20];
     std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
     return buffer;
 }
 
-// Function to parse status logs
-void parse_status_logs(const std::vector<nlohmann::json> &status_logs,
-                       std::map<std::pair<int, int>, std::vector<std::chrono::system_clock::time_point>> &cell_visit_times,
-                       const int areaSize) {
-    for (const auto &status : status_logs) {
-        int drone_id = status["drone_id"];
-        double x = status["position"]["x"];
-        double y = status["position"]["y"];
-        double battery_level = status["battery_level"];
-        std::string timestamp_str = status["timestamp"];
-
-        if (battery_level <= 0 || battery_level >100) {
-            logVisit("Drone " + std::to_string(drone_id), "Invalid battery level: " + std::to_string(battery_level), timestamp_str);
-        }
+// Report a cell that has not been visited for max_interval, on stdout, in the log and on monitor:violations
+void report_overdue_cell(const std::shared_ptr<Redis> &redis, const RevisitTracker::Gap &gap, const Grid &grid,
+                         const std::chrono::minutes &max_interval) {
+    const int cell_x = gap.cellIndex % grid.getCols();
+    const int cell_y = gap.cellIndex / grid.getCols();
+    const std::string message = "Cell (" + std::to_string(cell_x) + ", " + std::to_string(cell_y) + ") not visited for "
+                                + std::to_string(max_interval.count()) + " minutes, last visit at " + format_time_point(gap.lastVisit);
+    std::cout << message << std::endl;
+    logWarning("Monitor", message);
+    redis->publish("monitor:violations", nlohmann::json{
+        {"cell", {cell_x, cell_y}},
+        {"last_visit", gap.lastVisit.time_since_epoch().count()}
+    }.dump());
+}
+
+// Long-running mode: consume status_logs through the consumer group, keep the last visit of every cell and report
+// each cell as soon as it goes max_interval without a visit.
+// Processed entries are acknowledged right after a checkpoint of the revisit state (stored under
+// monitor:<group>:checkpoint), so a restarted monitor resumes from the checkpoint and is redelivered exactly the
+// entries processed after it; replaying them is harmless since a visit only ever moves a cell's last visit forward.
+// A checkpoint only writes the cells changed since the previous one (delta:<n>, up to last) on top of a full state
+// (state, as of delta base). The full state is written again once the deltas add up to its size, so a checkpoint
+// costs about the changes since the previous one and a restart reads at most about twice the state.
+// Time is drone time: the latest timestamp read, advanced by the wall clock while the stream is silent, so overdue
+// cells are still reported if every drone stops logging.
+// The revisit state needs every entry, so a group has a single consumer: it holds monitor:<group>:owner, renewed while
+// it runs, and a monitor started under another consumer name exits while the lease is held
+[[noreturn]] void follow_status_logs(const std::shared_ptr<Redis> &redis, const Grid &grid, const std::chrono::minutes &max_interval,
+                                     const std::string &group, const std::string &consumer) {
+    using Attrs = std::vector<std::pair<std::string, std::string>>;
+    using Item = std::pair<std::string, Optional<Attrs>>;
+    using ItemStream = std::vector<Item>;
+    const std::string stream_key = "status_logs";
+    const std::string checkpoint_key = "monitor:" + group + ":checkpoint";
+    const std::string owner_key = "monitor:" + group + ":owner";
+    constexpr long long batch_size = 1024;
+    constexpr auto checkpoint_interval = std::chrono::seconds(5);
+    constexpr auto lease_duration = std::chrono::seconds(30);
+
+    // Take the group, or take it back after a restart under the same name
+    const auto hold_lease = [&]() {
+        if (redis->set(owner_key, consumer, lease_duration, UpdateType::NOT_EXIST))
+            return true;
+        if (redis->get(owner_key).value_or("") != consumer)
+            return false;
+        redis->expire(owner_key, std::chrono::duration_cast<std::chrono::seconds>(lease_duration));
+        return true;
+    };
+    if (!hold_lease()) {
+        const std::string message = "Group " + group + " is already followed by " + redis->get(owner_key).value_or("another consumer")
+                                    + ", a group has a single consumer";
+        std::cerr << message << std::endl;
+        logError("Monitor", message);
+        std::exit(1);
+    }
+
+    try {
+        redis->xgroup_create(stream_key, group, "0", true);
+    } catch (const ReplyError &) {
+        // The group already exists: resume it
+    }
 
-        // Parse timestamp
-        std::tm tm = {};
-        std::istringstream ss(timestamp_str);
-        ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-        if (ss.fail()) {
-            std::cerr << "Failed to parse timestamp: " << timestamp_str << std::endl;
-            continue;
+    RevisitTracker tracker(grid.getCellCount(), max_interval);
+    std::chrono::system_clock::time_point stream_time;      // Latest timestamp read
+    unsigned long long base = 0, last = 0;                  // Deltas of the checkpoint
+    std::size_t state_size = 0, delta_size = 0;             // Size of its full state, and of its deltas
+    {
+        std::unordered_map<std::string, std::string> checkpoint;
+        redis->hgetall(checkpoint_key, std::inserter(checkpoint, checkpoint.end()));
+        std::optional<long long> time;
+        try {
+            if (checkpoint.count("time") != 0)
+                time = std::stoll(checkpoint["time"]);
+            // Checkpoints written before deltas have neither
+            if (checkpoint.count("base") != 0)
+                base = std::stoull(checkpoint["base"]);
+            if (checkpoint.count("last") != 0)
+                last = std::stoull(checkpoint["last"]);
+        } catch (const std::exception &) {
+            time.reset();   // Unreadable, start over
+        }
+        bool restored = time && base <= last && checkpoint.count("state") != 0 && tracker.restore(checkpoint["state"]);
+        for (auto delta = base + 1; restored && delta <= last; ++delta) {
+            const auto changes = checkpoint.find("delta:" + std::to_string(delta));
+            restored = changes != checkpoint.end() && tracker.applyChanges(changes->second);
+            if (restored)
+                delta_size += changes->second.size();
         }
-        std::time_t time_t_timestamp = std::mktime(&tm);
-        std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::from_time_t(time_t_timestamp);
-
-        // Map coordinates to cell indices (assuming cell size is 20m)
-        int cell_x = static_cast<int>(x / 20.0);
-        int cell_y = static_cast<int>(y / 20.0);
-
-        int boundary_x = static_cast<int>(areaSize/20);
-        int boundary_y = static_cast<int>(areaSize/20);
-
-        // Ensure indices are within bounds (0 to 299)
-        if (cell_x >= 0 && cell_x < boundary_x && cell_y >= 0 && cell_y < boundary_y) {
-            std::pair<int, int> cell_coord = std::make_pair(cell_x, cell_y);
-            std::cout << "Cell with coordinates (" << cell_x << ", " << cell_y << ") visited at time " << format_time_point(timestamp) << std::endl;
-            logVisit("Drone" + std::to_string(drone_id), "Visited cell with coordinates (" + std::to_string(cell_x) + ", " + std::to_string(cell_y) + ")", format_time_point(timestamp));
-            cell_visit_times[cell_coord].push_back(timestamp);
+        if (restored) {
+            stream_time = std::chrono::system_clock::time_point(std::chrono::system_clock::duration(*time));
+            state_size = checkpoint["state"].size();
+            logInfo("Monitor", "Resuming from checkpoint at entry " + checkpoint["entry"]);
         } else {
-            std::cerr << "Invalid cell coordinates: (" << cell_x << ", " << cell_y << ") for position (" << x << ", " << y << ")" << std::endl;
-            logVisit("Drone " + std::to_string(drone_id), "Position out of bound: " + std::to_string(x) + ", " + std::to_string(y) + ")", format_time_point(timestamp));
+            tracker = RevisitTracker(grid.getCellCount(), max_interval);
+            base = last = 0;
+            delta_size = 0;
+            if (!checkpoint.empty()) {
+                logWarning("Monitor", "Ignoring the incomplete checkpoint " + checkpoint_key);
+                redis->del(checkpoint_key);
+            }
         }
     }
+    auto stream_time_read = std::chrono::steady_clock::now();     // When stream_time last moved
+
+    std::string read_id = "0";     // Entries delivered before a restart and never acknowledged first, then new ones (">")
+    std::vector<std::string> processed;
+    auto last_checkpoint = std::chrono::steady_clock::now();
+    auto last_renewal = last_checkpoint;
+    std::vector<RevisitTracker::Gap> overdue;
+    logInfo("Monitor", "Following " + stream_key + " as " + consumer + " in group " + group);
+
+    while (true) {
+        std::unordered_map<std::string, ItemStream> result;
+        redis->xreadgroup(group, consumer, stream_key, read_id, std::chrono::seconds(1), batch_size, std::inserter(result, result.end()));
+        const ItemStream &items = result[stream_key];
+        if (read_id != ">")
+            read_id = items.empty() ? ">" : items.back().first;
+
+        for (const auto &[id, attrs] : items) {
+            processed.push_back(id);
+            if (!attrs)
+                continue;   // Trimmed from the stream before it was read
+            const auto visit = read_cell_visit(*attrs, grid);
+            if (!visit)
+                continue;
+            if (!tracker.isStarted())
+                tracker.start(visit->time);
+            if (visit->time > stream_time) {
+                stream_time = visit->time;
+                stream_time_read = std::chrono::steady_clock::now();
+            }
+            if (const auto gap = tracker.visit(visit->cell_index, visit->time)) {
+                const auto minutes = std::chrono::duration_cast<std::chrono::minutes>(visit->time - gap->lastVisit);
+                logInfo("Monitor", "Cell " + std::to_string(visit->cell_index) + " visited again by drone " + std::to_string(visit->drone_id)
+                                   + " after " + std::to_string(minutes.count()) + " minutes");
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_renewal >= checkpoint_interval) {
+            if (!hold_lease()) {
+                logError("Monitor", "Lost group " + group + " to " + redis->get(owner_key).value_or("another consumer") + ", stopping");
+                std::exit(1);
+            }
+            last_renewal = now;
+        }
+        if (tracker.isStarted()) {
+            tracker.collectOverdue(stream_time + std::chrono::duration_cast<std::chrono::system_clock::duration>(now - stream_time_read), overdue);
+            for (const auto &gap : overdue)
+                report_overdue_cell(redis, gap, grid, max_interval);
+        }
 
-    // Sort visit times for each cell
-    for (auto &cell_entry : cell_visit_times) {
-        std::sort(cell_entry.second.begin(), cell_entry.second.end());
+        if (!processed.empty() && now - last_checkpoint >= checkpoint_interval) {
+            // One HSET, so the position in the stream and the revisit state always match
+            std::vector<std::pair<std::string, std::string>> checkpoint = {
+                {"entry", processed.back()},
+                {"time", std::to_string(stream_time.time_since_epoch().count())}
+            };
+            std::string changes = tracker.serializeChanges();
+            const auto previous_base = base;
+            if (state_size == 0 || delta_size + changes.size() >= state_size) {
+                std::string state = tracker.serialize();
+                state_size = state.size();
+                delta_size = 0;
+                base = last;
+                checkpoint.emplace_back("state", std::move(state));
+                checkpoint.emplace_back("base", std::to_string(base));
+            } else {
+                delta_size += changes.size();
+                checkpoint.emplace_back("delta:" + std::to_string(++last), std::move(changes));
+            }
+            checkpoint.emplace_back("last", std::to_string(last));
+            redis->hset(checkpoint_key, checkpoint.begin(), checkpoint.end());
+            tracker.clearChanges();
+            redis->xack(stream_key, group, processed.begin(), processed.end());
+            processed.clear();
+            last_checkpoint = now;
+
+            // The deltas the new state includes are never read again
+            if (base != previous_base) {
+                std::vector<std::string> stale;
+                for (auto delta = previous_base + 1; delta <= base; ++delta)
+                    stale.push_back("delta:" + std::to_string(delta));
+                redis->hdel(checkpoint_key, stale.begin(), stale.end());
+            }
+        }
     }
 }
 
-
-
-// Function to analyze cell visits
-void analyze_cell_visits(const std::map<std::pair<int, int>, std::vector<std::chrono::system_clock::time_point>> &cell_visit_times,
-                         const std::chrono::system_clock::time_point &simulation_start_time,
-                         const std::chrono::system_clock::time_point &simulation_end_time,
-                         const std::chrono::minutes &max_interval,
-                         const int areaSize) {
-    bool all_cells_ok = true;
-    
-    int boundary_x = static_cast<int>(areaSize/20);
-    int boundary_y = static_cast<int>(areaSize/20);
-
-    // Iterate over all possible cells in the grid
-    for (int x = 0; x < boundary_x; ++x) {
-        for (int y = 0; y < boundary_y; ++y) {
-            std::pair<int, int> cell_coord = std::make_pair(x, y);
-            auto it = cell_visit_times.find(cell_coord);
-
-            if (it == cell_visit_times.end()) {
-                // Cell was never visited
-                all_cells_ok = false;
-                std::cout << "Cell (" << x << ", " << y << ") was never visited during the simulation." << std::endl;
-            } else {
-                const auto &visits = it->second;
-
-                auto interval = std::chrono::duration_cast<std::chrono::minutes>(visits.front() - simulation_start_time);
-                // Check intervals between visits
-                for (size_t i = 1; i < visits.size(); ++i) {
-                    interval = std::chrono::duration_cast<std::chrono::minutes>(visits[i] - visits[i - 1]);
-                    if (interval >= max_interval) {
-                        all_cells_ok = false;
-                        std::cout << "Cell (" << x << ", " << y << ") was not visited for " << interval.count() << " minutes between " << format_time_point(visits[i - 1]) << " and " << format_time_point(visits[i]) << "." << std::endl;
+// Print every cell that went max_interval or more without a visit, then a histogram of the revisit intervals.
+// Rows are split across one thread per core, each one writes the report of its rows, printed in row order
+void report_revisits(const RevisitTracker &tracker, const Grid &grid, const std::chrono::minutes &max_interval) {
+    const int rows = grid.getRows();
+    const int cols = grid.getCols();
+    const int threads = std::max(1, std::min(rows, static_cast<int>(std::thread::hardware_concurrency())));
+
+    struct Block {
+        std::string report;
+        std::size_t cells_late = 0;
+        std::size_t never_visited = 0;
+        std::array<uint64_t, RevisitTracker::histogramBins> histogram{};
+    };
+    std::vector<Block> blocks(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            Block &block = blocks[t];
+            std::ostringstream report;
+            for (int y = rows * t / threads; y < rows * (t + 1) / threads; ++y) {
+                for (int x = 0; x < cols; ++x) {
+                    const auto stats = tracker.getStats(y * cols + x);
+                    for (int b = 0; b < RevisitTracker::histogramBins; ++b)
+                        block.histogram[b] += stats.histogram[b];
+                    if (!stats.visited) {
+                        block.never_visited++;
+                        report << "Cell (" << x << ", " << y << ") was never visited during the simulation." << std::endl;
+                    } else if (stats.violations != 0) {
+                        block.cells_late++;
+                        report << "Cell (" << x << ", " << y << ") was not visited for " << max_interval.count() << " minutes or more "
+                               << stats.violations << " times, longest gap " << std::chrono::duration_cast<std::chrono::minutes>(stats.maxGap).count()
+                               << " minutes, last visit at " << format_time_point(stats.lastVisit) << "." << std::endl;
                     }
                 }
-
-                // Check from last visit to simulation end
-                interval = std::chrono::duration_cast<std::chrono::minutes>(simulation_end_time - visits.back());
-                if (interval >= max_interval) {
-                    all_cells_ok = false;
-                    std::cout << "Cell (" << x << ", " << y << ") was not visited in the last " << max_interval.count() << " minutes before simulation end." << std::endl;
-                    std::cout << "Last visit at: " << format_time_point(visits.back()) << std::endl;
-                }
             }
-        }
+            block.report = report.str();
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    Block total;
+    for (const auto &block : blocks) {
+        std::cout << block.report;
+        total.cells_late += block.cells_late;
+        total.never_visited += block.never_visited;
+        for (int b = 0; b < RevisitTracker::histogramBins; ++b)
+            total.histogram[b] += block.histogram[b];
     }
 
-    if (all_cells_ok) {
+    if (total.cells_late == 0 && total.never_visited == 0) {
         std::cout << "All cells were visited within every " << max_interval.count() << "-minute interval." << std::endl;
+    } else {
+        logWarning("Monitor", std::to_string(total.cells_late) + " cells left unvisited for " + std::to_string(max_interval.count())
+                              + " minutes or more, " + std::to_string(total.never_visited) + " never visited");
+    }
+    const double bin_minutes = max_interval.count() / 4.0;
+    std::cout << "Revisit intervals:" << std::endl << std::fixed << std::setprecision(2);
+    for (int b = 0; b < RevisitTracker::histogramBins; ++b) {
+        std::cout << "  " << b * bin_minutes;
+        if (b + 1 < RevisitTracker::histogramBins)
+            std::cout << " - " << (b + 1) * bin_minutes;
+        else
+            std::cout << "+";
+        std::cout << " min: " << total.histogram[b] << std::endl;
     }
 }
 
+// One pass over the whole stream, read in pages so the memory only depends on the grid. Returns false if it is empty
+bool analyze_status_logs(const std::shared_ptr<Redis> &redis, const Grid &grid, const std::chrono::minutes &max_interval) {
+    using Attrs = std::vector<std::pair<std::string, std::string>>;
+    const std::string stream_key = "status_logs";
+    constexpr long long page_size = 10000;
+
+    RevisitTracker tracker(grid.getCellCount(), max_interval);
+    std::chrono::system_clock::time_point start_time = std::chrono::system_clock::time_point::max();
+    std::chrono::system_clock::time_point end_time = std::chrono::system_clock::time_point::min();
+    std::size_t entry_count = 0;
+    std::vector<std::pair<std::string, Attrs>> entries;
+    for (std::string from = "-";; from = "(" + entries.back().first) {
+        entries.clear();
+        redis->xrange(stream_key, from, "+", page_size, std::back_inserter(entries));
+        for (const auto &[id, attrs] : entries) {
+            const auto visit = read_cell_visit(attrs, grid);
+            if (!visit)
+                continue;
+            if (!tracker.isStarted())
+                tracker.start(visit->time);
+            tracker.visit(visit->cell_index, visit->time);
+            start_time = std::min(start_time, visit->time);
+            end_time = std::max(end_time, visit->time);
+        }
+        entry_count += entries.size();
+        if (entries.size() < static_cast<std::size_t>(page_size))
+            break;
+    }
+
+    if (entry_count == 0) {
+        std::cerr << "No entries found in the status_logs stream." << std::endl;
+        logError("Monitor", "No entries found in the status_logs stream.");
+        return false;
+    }
+    if (!tracker.isStarted()) {
+        std::cerr << "No valid timestamps found in the status logs." << std::endl;
+        return false;
+    }
+    tracker.close(end_time);
+    logInfo("Monitor", std::to_string(entry_count) + " entries from " + format_time_point(start_time) + " to " + format_time_point(end_time));
+    report_revisits(tracker, grid, max_interval);
+    return true;
+}
 
 int main(int argc, char* argv[]) {
     // Check if area size is provided as a command-line argument
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <area_size>" << std::endl;
+    const CommandLine commandLine(argc, argv);
+    if (commandLine.positional().size() != 1) {
+        std::cerr << "Usage: " << argv[0] << " <area_size> [--follow] [--group=name] [--consumer=name]" << std::endl;
         return 1;  // Exit with error code if area_size is not provided
     }
 
     int area_size;
     try {
-        area_size = std::stoi(argv[1]);
+        area_size = std::stoi(commandLine.positional()[0]);
     } catch (const std::invalid_argument& e) {
         std::cerr << "Invalid area size argument. Please provide a valid integer for area size." << std::endl;
         return 1;
@@ -206,31 +356,16 @@ int main(int argc, char* argv[]) {
     std::string logFile = "drone_monitoring.log"; // adjust the filename to be unique using timestamp di needed
     openLogFiles(logFile);
 
-    // Data structures to hold visit times and simulation time frame
-    std::vector<nlohmann::json> status_logs;
-    std::map<std::pair<int, int>, std::vector<std::chrono::system_clock::time_point>> cell_visit_times;
-    std::chrono::system_clock::time_point simulation_start_time;
-    std::chrono::system_clock::time_point simulation_end_time;
-
-    // Retrieve status logs from Redis
-    retrieve_status_logs_from_redis(redis, status_logs, simulation_start_time, simulation_end_time);
-
-    if (status_logs.empty()) {
-        std::cerr << "No status logs found in Redis." << std::endl;
-        return 1;
-    }
+    const Grid grid(area_size, area_size);
 
-    // Parse the status logs
-    parse_status_logs(status_logs, cell_visit_times, area_size);
+    // --follow: check the revisit interval continuously instead of analyzing the whole stream once and deleting it.
+    // --group=name: consumer group, its checkpoint survives restarts (default "monitor"); --consumer=name: this instance
+    if (commandLine.has("follow"))
+        follow_status_logs(redis, grid, max_interval, commandLine.value("group", "monitor"), commandLine.value("consumer", "monitor-1"));
 
-    if (simulation_start_time == std::chrono::system_clock::time_point::min() ||
-        simulation_end_time == std::chrono::system_clock::time_point::min()) {
-        std::cerr << "No valid timestamps found in the status logs." << std::endl;
+    // Analyze the whole stream in one pass
+    if (!analyze_status_logs(redis, grid, max_interval))
         return 1;
-    }
-
-    // Analyze the cell visits
-    analyze_cell_visits(cell_visit_times, simulation_start_time, simulation_end_time, max_interval, area_size);
 
     // After analysis
     redis->del("status_logs");
@@ -0,0 +1,272 @@
+#ifndef SKYWATCHER_REVISITTRACKER_H
+#define SKYWATCHER_REVISITTRACKER_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Revisit state of every cell of the grid in contiguous per-field arrays indexed by cell: last visit, longest gap,
+// number of gaps of maxInterval or more and a histogram of the revisit intervals. Each visit is an O(1) update, so the
+// memory only depends on the grid and a run is analyzed in one pass over its visits, in time order (a visit older than
+// the cell's last one is dropped). The first visit of a cell may be at the start time itself.
+// A cell is overdue once it has not been visited for maxInterval; it is reported once per gap, and the gap is closed
+// by the next visit.
+// Times are drone clock time points; not thread safe
+class RevisitTracker {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+    using Duration = std::chrono::system_clock::duration;
+
+    // Gap lengths in quarters of maxInterval, the last bin holds every gap of twice maxInterval or more
+    static constexpr int histogramBins = 8;
+
+    struct Gap {
+        int cellIndex;
+        TimePoint lastVisit;
+    };
+
+    struct CellStats {
+        bool visited;
+        TimePoint lastVisit;                        // Start of the observation if not visited
+        Duration maxGap;
+        uint32_t violations;                        // Gaps of maxInterval or more
+        std::array<uint32_t, histogramBins> histogram;  // Revisits only, not the gap left open at the end
+    };
+
+    RevisitTracker(const int cellCount, const Duration maxInterval)
+        : lastVisits(cellCount, TimePoint::min()), maxGaps(cellCount, Duration::zero()), violations(cellCount, 0),
+          flags(cellCount, 0), histograms(static_cast<std::size_t>(cellCount) * histogramBins, 0), maxInterval(maxInterval),
+          changed(cellCount, false) {}
+
+    // Start of the observation, cells never visited are overdue maxInterval after it
+    void start(const TimePoint time) {
+        for (auto &lastVisit : lastVisits)
+            if (lastVisit == TimePoint::min())
+                lastVisit = time;
+    }
+
+    [[nodiscard]] bool isStarted() const { return !lastVisits.empty() && lastVisits.front() != TimePoint::min(); }
+
+    // Record a visit. Returns the gap it closes if the cell was reported overdue
+    std::optional<Gap> visit(const int cellIndex, const TimePoint time) {
+        uint8_t &cellFlags = flags[cellIndex];
+        const bool revisit = cellFlags & visited;
+        if (revisit ? time <= lastVisits[cellIndex] : time < lastVisits[cellIndex])
+            return std::nullopt;
+        const Gap gap{cellIndex, lastVisits[cellIndex]};
+        recordGap(cellIndex, time - gap.lastVisit);
+        if (revisit)
+            histograms[static_cast<std::size_t>(cellIndex) * histogramBins + bin(time - gap.lastVisit)]++;
+        lastVisits[cellIndex] = time;
+        const bool wasOverdue = cellFlags & overdue;
+        cellFlags = visited;
+        markChanged(cellIndex);
+        if (!wasOverdue)
+            return std::nullopt;
+        return gap;
+    }
+
+    // End of the observation: the gap still open in each cell counts towards its longest gap and violations
+    void close(const TimePoint end) {
+        for (int cell = 0; cell < getCellCount(); ++cell)
+            if (end > lastVisits[cell])
+                recordGap(cell, end - lastVisits[cell]);
+    }
+
+    // Cells that became overdue at now, each reported once per gap
+    void collectOverdue(const TimePoint now, std::vector<Gap> &out) {
+        out.clear();
+        for (int cell = 0; cell < getCellCount(); ++cell) {
+            if (!(flags[cell] & overdue) && now - lastVisits[cell] >= maxInterval) {
+                flags[cell] |= overdue;
+                markChanged(cell);
+                out.push_back({cell, lastVisits[cell]});
+            }
+        }
+    }
+
+    [[nodiscard]] int getCellCount() const { return static_cast<int>(lastVisits.size()); }
+
+    [[nodiscard]] CellStats getStats(const int cellIndex) const {
+        CellStats stats{(flags[cellIndex] & visited) != 0, lastVisits[cellIndex], maxGaps[cellIndex], violations[cellIndex], {}};
+        std::copy_n(histograms.begin() + static_cast<std::ptrdiff_t>(cellIndex) * histogramBins, histogramBins, stats.histogram.begin());
+        return stats;
+    }
+
+    // Checkpoint layout: cell count (u32) | for each cell, last visit and longest gap (i64 ticks), violations (u32),
+    // flags (u8: 1 if overdue, 2 if visited) and the histogram (u32 per bin)
+    [[nodiscard]] std::string serialize() const {
+        std::string out;
+        out.reserve(4 + cellSize * lastVisits.size());
+        putU32(out, static_cast<uint32_t>(lastVisits.size()));
+        for (int cell = 0; cell < getCellCount(); ++cell)
+            putCell(out, cell);
+        return out;
+    }
+
+    // Restore a checkpoint of the same grid, false (and unchanged) otherwise. Starts with no changes
+    bool restore(const std::string &checkpoint) {
+        Reader reader{checkpoint};
+        uint32_t count;
+        if (!reader.u32(count) || count != lastVisits.size())
+            return false;
+        RevisitTracker restored(static_cast<int>(count), maxInterval);
+        for (uint32_t cell = 0; cell < count; ++cell)
+            if (!restored.readCell(reader, static_cast<int>(cell), true))
+                return false;
+        if (!reader.done())
+            return false;
+        *this = std::move(restored);
+        return true;
+    }
+
+    // Cells visited or reported overdue since the last clearChanges, so a checkpoint can be followed by the cells it
+    // no longer matches instead of the whole grid
+    [[nodiscard]] std::size_t getChangeCount() const { return changedCells.size(); }
+
+    // Changes layout: count (u32) | for each changed cell, its index (u32) and its state as in serialize
+    [[nodiscard]] std::string serializeChanges() const {
+        std::string out;
+        out.reserve(4 + (4 + cellSize) * changedCells.size());
+        putU32(out, static_cast<uint32_t>(changedCells.size()));
+        for (const int cell : changedCells) {
+            putU32(out, static_cast<uint32_t>(cell));
+            putCell(out, cell);
+        }
+        return out;
+    }
+
+    void clearChanges() {
+        for (const int cell : changedCells)
+            changed[cell] = false;
+        changedCells.clear();
+    }
+
+    // Apply changes serialized from a tracker of the same grid, on top of the checkpoint they follow. False (and
+    // unchanged) if they are invalid
+    bool applyChanges(const std::string &changes) {
+        return readChanges(changes, false) && readChanges(changes, true);
+    }
+
+private:
+    std::vector<TimePoint> lastVisits;      // TimePoint::min() until start
+    std::vector<Duration> maxGaps;
+    std::vector<uint32_t> violations;
+    std::vector<uint8_t> flags;             // overdue | visited
+    std::vector<uint32_t> histograms;       // histogramBins per cell
+    Duration maxInterval;
+    std::vector<bool> changed;              // Since the last clearChanges
+    std::vector<int> changedCells;
+
+    static constexpr std::size_t cellSize = 21 + 4 * histogramBins;
+
+    static constexpr uint8_t overdue = 1;   // Reported overdue, not visited since
+    static constexpr uint8_t visited = 2;
+
+    // Little-endian checkpoint encoding
+    static void putU32(std::string &out, const uint32_t value) {
+        for (int i = 0; i < 4; ++i)
+            out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    static void putU64(std::string &out, const uint64_t value) {
+        for (int i = 0; i < 8; ++i)
+            out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    // Sequential reader, fails (instead of reading past the end) on truncated input
+    struct Reader {
+        const std::string &data;
+        std::size_t offset = 0;
+
+        bool u8(uint8_t &value) {
+            if (data.size() - offset < 1) return false;
+            value = static_cast<uint8_t>(data[offset++]);
+            return true;
+        }
+
+        bool u32(uint32_t &value) {
+            if (data.size() - offset < 4) return false;
+            value = 0;
+            for (int i = 0; i < 4; ++i)
+                value |= static_cast<uint32_t>(static_cast<uint8_t>(data[offset++])) << (8 * i);
+            return true;
+        }
+
+        bool u64(uint64_t &value) {
+            if (data.size() - offset < 8) return false;
+            value = 0;
+            for (int i = 0; i < 8; ++i)
+                value |= static_cast<uint64_t>(static_cast<uint8_t>(data[offset++])) << (8 * i);
+            return true;
+        }
+
+        [[nodiscard]] bool done() const { return offset == data.size(); }
+    };
+
+    void markChanged(const int cell) {
+        if (!changed[cell]) {
+            changed[cell] = true;
+            changedCells.push_back(cell);
+        }
+    }
+
+    void putCell(std::string &out, const int cell) const {
+        putU64(out, static_cast<uint64_t>(lastVisits[cell].time_since_epoch().count()));
+        putU64(out, static_cast<uint64_t>(maxGaps[cell].count()));
+        putU32(out, violations[cell]);
+        out.push_back(static_cast<char>(flags[cell]));
+        for (int b = 0; b < histogramBins; ++b)
+            putU32(out, histograms[static_cast<std::size_t>(cell) * histogramBins + b]);
+    }
+
+    // Read the state of a cell, stored only if store is set, so a whole message can be checked before it is applied
+    bool readCell(Reader &reader, const int cell, const bool store) {
+        uint64_t lastVisit, maxGap;
+        uint32_t cellViolations;
+        uint8_t cellFlags;
+        std::array<uint32_t, histogramBins> histogram;
+        if (!reader.u64(lastVisit) || !reader.u64(maxGap) || !reader.u32(cellViolations) || !reader.u8(cellFlags) || cellFlags > (overdue | visited))
+            return false;
+        for (auto &count : histogram)
+            if (!reader.u32(count))
+                return false;
+        if (store) {
+            lastVisits[cell] = TimePoint(Duration(static_cast<int64_t>(lastVisit)));
+            maxGaps[cell] = Duration(static_cast<int64_t>(maxGap));
+            violations[cell] = cellViolations;
+            flags[cell] = cellFlags;
+            std::copy(histogram.begin(), histogram.end(), histograms.begin() + static_cast<std::ptrdiff_t>(cell) * histogramBins);
+        }
+        return true;
+    }
+
+    bool readChanges(const std::string &changes, const bool store) {
+        Reader reader{changes};
+        uint32_t count;
+        if (!reader.u32(count))
+            return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t cell;
+            if (!reader.u32(cell) || cell >= lastVisits.size() || !readCell(reader, static_cast<int>(cell), store))
+                return false;
+        }
+        return reader.done();
+    }
+
+    [[nodiscard]] int bin(const Duration gap) const {
+        return static_cast<int>(std::min<Duration::rep>(gap * 4 / maxInterval, histogramBins - 1));
+    }
+
+    void recordGap(const int cellIndex, const Duration gap) {
+        maxGaps[cellIndex] = std::max(maxGaps[cellIndex], gap);
+        violations[cellIndex] += gap >= maxInterval;
+    }
+};
+
+
+#endif //SKYWATCHER_REVISITTRACKER_H
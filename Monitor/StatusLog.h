@@ -0,0 +1,55 @@
+#ifndef SKYWATCHER_STATUSLOG_H
+#define SKYWATCHER_STATUSLOG_H
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "Utils/GridDefinitions.h"
+#include "Utils/Logger.h"
+#include "Utils/WireFormat.h"
+
+// Visit of a cell read from a status_logs entry
+struct CellVisit {
+    int drone_id;
+    int cell_index;
+    std::chrono::system_clock::time_point time;
+};
+
+// Cell visited by a status or cell event entry, nullopt if it is invalid or outside the area
+inline std::optional<CellVisit> read_cell_visit(const std::vector<std::pair<std::string, std::string>> &fields, const Grid &grid) {
+    for (const auto &[field, value] : fields) {
+        if (field == "cell") {
+            const auto event = wire::decodeCellEvent(value);
+            if (!event || event->cellX < 0 || event->cellX >= grid.getCols() || event->cellY < 0 || event->cellY >= grid.getRows())
+                return std::nullopt;
+            return CellVisit{event->droneID, event->cellY * grid.getCols() + event->cellX, event->timestamp};
+        }
+        if (field == "status") {
+            try {
+                const nlohmann::json status = nlohmann::json::parse(value);
+                const std::string timestamp_str = status.at("timestamp");
+                std::tm tm = {};
+                std::istringstream ss(timestamp_str);
+                ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+                const GridLocation location = grid.locate(status.at("position").get<Position>());
+                if (ss.fail() || location.cellIndex == -1)
+                    return std::nullopt;
+                if (const double battery_level = status.value("battery_level", 100.0); battery_level <= 0 || battery_level > 100)
+                    logVisit("Drone " + std::to_string(status.at("drone_id").get<int>()), "Invalid battery level: " + std::to_string(battery_level), timestamp_str);
+                return CellVisit{status.at("drone_id"), location.cellIndex, std::chrono::system_clock::from_time_t(std::mktime(&tm))};
+            } catch (const nlohmann::json::exception &) {
+                return std::nullopt;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+
+#endif //SKYWATCHER_STATUSLOG_H
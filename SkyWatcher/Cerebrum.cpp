@@ -2,11 +2,28 @@
 
 using namespace operations_research;
 
+// True if waypoint i is the center of cell (i / Side, i % Side) of a regular lattice, as laid out by BasicSector
+template <int Side>
+static bool isCanonicalLayout(const typename SectorGeometry<Side>::Waypoints &positions) {
+    const double stepX = positions[1].x - positions[0].x;
+    const double stepY = positions[Side].y - positions[0].y;
+    if (stepX <= 0 || stepY <= 0)
+        return false;
+    for (int i = 0; i < SectorGeometry<Side>::cells; ++i) {
+        const Position expected = {positions[0].x + (i % Side) * stepX, positions[0].y + (i / Side) * stepY};
+        if (std::abs(positions[i].x - expected.x) > 1e-3 || std::abs(positions[i].y - expected.y) > 1e-3)
+            return false;
+    }
+    return true;
+}
+
 
-Cerebrum::Cerebrum(const std::vector<std::shared_ptr<Sector>> &s) : sectors(s) {
+template <int Side>
+BasicCerebrum<Side>::BasicCerebrum(const std::vector<std::shared_ptr<BasicSector<Side>>> &s, const SolverBackend backend, const std::string &tourCachePath)
+    : sectors(s), backend(backend), tourCache(tourCachePath) {
     // Get first sector of region D
     logInfo("Tower", "Solving TSP problem for sectors...");
-    const Sector *sector = sectors[0].get();
+    const BasicSector<Side> *sector = sectors[0].get();
     // Solve TSP for the first sector
     solveTSP(sector->getWaypoints(), sector->getStartingIndex());
     for (const auto &sect : sectors) {
@@ -14,7 +31,8 @@ Cerebrum::Cerebrum(const std::vector<std::shared_ptr<Sector>> &s) : sectors(s) {
     }
 }
 
-void visualizeTour(const std::vector<RoutingNodeIndex>& tour, const std::array<Position, 100>& cell_positions) {
+template <std::size_t N>
+void visualizeTour(const std::vector<int>& tour, const std::array<Position, N>& cell_positions) {
     // Set up the window
     constexpr int window_width = 800;
     constexpr int window_height = 800;
@@ -67,8 +85,8 @@ void visualizeTour(const std::vector<RoutingNodeIndex>& tour, const std::array<P
 
     // Extract the positions in the order of the tour
     std::vector<Position> tour_positions;
-    for (RoutingNodeIndex node_index : tour) {
-        tour_positions.push_back(cell_positions[node_index.value()]);
+    for (const int node_index : tour) {
+        tour_positions.push_back(cell_positions[node_index]);
     }
 
     // Create vertices for the path
@@ -83,9 +101,9 @@ void visualizeTour(const std::vector<RoutingNodeIndex>& tour, const std::array<P
     path_vertices.push_back(path_vertices.front());
 
     // Highlight the starting point
-    RoutingNodeIndex start_node_index = tour.front();
-    cell_shapes[start_node_index.value()].setFillColor(sf::Color::Green);
-    cell_shapes[start_node_index.value()].setRadius(cell_radius * 1.5f);
+    const int start_node_index = tour.front();
+    cell_shapes[start_node_index].setFillColor(sf::Color::Green);
+    cell_shapes[start_node_index].setRadius(cell_radius * 1.5f);
 
     // Main loop
     while (window.isOpen()) {
@@ -112,59 +130,215 @@ void visualizeTour(const std::vector<RoutingNodeIndex>& tour, const std::array<P
 }
 
 
-std::array<std::array<int, 100>, 100> Cerebrum::ComputeDistanceMatrix(const std::array<Position, 100> &positions) {
-    const size_t size = positions.size();
-    std::array<std::array<int, 100>, 100> distance_matrix{};
-    for (size_t from = 0; from < size; ++from) {
-        for (size_t to = 0; to < size; ++to) {
-            if (from == to) continue;
-            const double dx = positions[from].x - positions[to].x;
-            const double dy = positions[from].y - positions[to].y;
-            const double distance = std::sqrt(dx * dx + dy * dy);
-            distance_matrix[from][to] = static_cast<int>(distance * 1000); // Scale if needed.
-        }
-    }
-    return distance_matrix;
-}
+// OR-tools search configurations run by the portfolio, in tie-breaking order (the first one is the single-search default)
+static constexpr std::array<std::pair<FirstSolutionStrategy::Value, LocalSearchMetaheuristic::Value>, 8> portfolioStrategies = {{
+    {FirstSolutionStrategy::PATH_CHEAPEST_ARC, LocalSearchMetaheuristic::GUIDED_LOCAL_SEARCH},
+    {FirstSolutionStrategy::SAVINGS, LocalSearchMetaheuristic::GUIDED_LOCAL_SEARCH},
+    {FirstSolutionStrategy::CHRISTOFIDES, LocalSearchMetaheuristic::GUIDED_LOCAL_SEARCH},
+    {FirstSolutionStrategy::PATH_CHEAPEST_ARC, LocalSearchMetaheuristic::SIMULATED_ANNEALING},
+    {FirstSolutionStrategy::PARALLEL_CHEAPEST_INSERTION, LocalSearchMetaheuristic::TABU_SEARCH},
+    {FirstSolutionStrategy::GLOBAL_CHEAPEST_ARC, LocalSearchMetaheuristic::GUIDED_LOCAL_SEARCH},
+    {FirstSolutionStrategy::LOCAL_CHEAPEST_INSERTION, LocalSearchMetaheuristic::SIMULATED_ANNEALING},
+    {FirstSolutionStrategy::SAVINGS, LocalSearchMetaheuristic::TABU_SEARCH}
+}};
 
-void Cerebrum::solveTSP(const std::array<Position, 100> &positions, int starting_index) {
+// Single OR-tools search that stops at deadline, returns the tour as waypoint indices starting from starting_index (empty if none found).
+// If initialTour is given the search starts from it instead of building a first solution
+static std::vector<int> runSearch(const DistanceMatrix &distance_matrix, const int starting_index,
+                                  const FirstSolutionStrategy::Value firstSolution, const LocalSearchMetaheuristic::Value metaheuristic,
+                                  const std::chrono::steady_clock::time_point deadline, const std::vector<int> *initialTour = nullptr) {
     RoutingNodeIndex start_index(starting_index);
-    Position starting_position = positions[starting_index];
 
-    const auto distance_matrix = ComputeDistanceMatrix(positions);
-    RoutingIndexManager manager((positions.size()), 1, start_index);
+    RoutingIndexManager manager(distance_matrix.getSize(), 1, start_index);
     RoutingModel routingModel(manager);
 
+    // Resolve the routing index -> node mapping once instead of on every arc evaluation
+    std::vector<int> index_to_node(manager.num_indices());
+    for (int index = 0; index < manager.num_indices(); ++index)
+        index_to_node[index] = manager.IndexToNode(index).value();
+
     const int transit_callback_index = routingModel.RegisterTransitCallback(
-            [&distance_matrix, &manager](int64_t from_index, int64_t to_index) -> int64_t {
-                const RoutingNodeIndex from_node = manager.IndexToNode(from_index);
-                const RoutingNodeIndex to_node = manager.IndexToNode(to_index);
-                return distance_matrix[from_node.value()][to_node.value()];
+            [&distance_matrix, &index_to_node](int64_t from_index, int64_t to_index) -> int64_t {
+                return distance_matrix(index_to_node[from_index], index_to_node[to_index]);
             }
     );
     routingModel.SetArcCostEvaluatorOfAllVehicles(transit_callback_index);
 
+    const auto remaining = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count());
     RoutingSearchParameters search_parameters = DefaultRoutingSearchParameters();
-    search_parameters.set_first_solution_strategy(FirstSolutionStrategy::PATH_CHEAPEST_ARC);
-    search_parameters.set_local_search_metaheuristic(LocalSearchMetaheuristic::GUIDED_LOCAL_SEARCH);
-    search_parameters.mutable_time_limit()->set_seconds(3);
+    search_parameters.set_first_solution_strategy(firstSolution);
+    search_parameters.set_local_search_metaheuristic(metaheuristic);
+    search_parameters.mutable_time_limit()->set_seconds(remaining / 1000);
+    search_parameters.mutable_time_limit()->set_nanos(static_cast<int>(remaining % 1000) * 1000000);
+
+    const Assignment* solution = nullptr;
+    if (initialTour != nullptr) {
+        // Warm start: the route lists the visited indices without the depot
+        routingModel.CloseModelWithParameters(search_parameters);
+        std::vector<int64_t> route;
+        for (size_t i = 1; i < initialTour->size(); ++i)
+            route.push_back(manager.NodeToIndex(RoutingNodeIndex((*initialTour)[i])));
+        if (const Assignment* initial = routingModel.ReadAssignmentFromRoutes({route}, true); initial != nullptr)
+            solution = routingModel.SolveFromAssignmentWithParameters(initial, search_parameters);
+    }
+    if (solution == nullptr)
+        solution = routingModel.SolveWithParameters(search_parameters);
 
-    if (const Assignment* solution = routingModel.SolveWithParameters(search_parameters); solution != nullptr) {
-        std::vector<RoutingNodeIndex> tour;
+    std::vector<int> tour;
+    if (solution != nullptr) {
         int64_t index = routingModel.Start(0);
         while (!routingModel.IsEnd(index)) {
-            RoutingNodeIndex node_index = manager.IndexToNode(index);
-            tour.push_back(node_index);
+            tour.push_back(index_to_node[index]);
             index = solution->Value(routingModel.NextVar(index));
         }
-        tour.push_back(start_index);
+    }
+    return tour;
+}
+
+// Length of the closed tour in distance matrix units
+static int64_t tourCost(const DistanceMatrix &distance_matrix, const std::vector<int> &tour) {
+    int64_t cost = 0;
+    for (size_t i = 0; i < tour.size(); ++i)
+        cost += distance_matrix(tour[i], tour[(i + 1) % tour.size()]);
+    return cost;
+}
+
+template <int Side>
+std::vector<int> BasicCerebrum<Side>::solveWithOrTools(const Waypoints &positions, const int starting_index, const int timeLimitSeconds) {
+    const DistanceMatrix distance_matrix(positions.data(), positions.size());
+    const auto [firstSolution, metaheuristic] = portfolioStrategies.front();
+    return runSearch(distance_matrix, starting_index, firstSolution, metaheuristic,
+                     std::chrono::steady_clock::now() + std::chrono::seconds(timeLimitSeconds));
+}
+
+template <int Side>
+std::vector<int> BasicCerebrum<Side>::solveWithPortfolio(const Waypoints &positions, const int starting_index, const int timeLimitSeconds, unsigned threads) {
+    const DistanceMatrix distance_matrix(positions.data(), positions.size());
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeLimitSeconds);
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, portfolioStrategies.size());
+
+    // Workers pull strategies until all ran. Each search gets the time limit divided by the number of rounds, so the
+    // strategies pulled last still run; one finishing early leaves its time to the next, and none runs past the deadline
+    const auto rounds = static_cast<unsigned>((portfolioStrategies.size() + threads - 1) / threads);
+    const auto slice = (deadline - std::chrono::steady_clock::now()) / rounds;
+    std::array<std::vector<int>, portfolioStrategies.size()> tours;
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < portfolioStrategies.size() && std::chrono::steady_clock::now() < deadline; i = next++) {
+                const auto [firstSolution, metaheuristic] = portfolioStrategies[i];
+                tours[i] = runSearch(distance_matrix, starting_index, firstSolution, metaheuristic,
+                                     std::min(deadline, std::chrono::steady_clock::now() + slice));
+            }
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    // Shortest tour wins, ties go to the earlier strategy so the result does not depend on thread timing
+    int best = -1;
+    int64_t bestCost = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < tours.size(); ++i) {
+        if (tours[i].size() != positions.size())
+            continue;
+        if (const int64_t cost = tourCost(distance_matrix, tours[i]); cost < bestCost) {
+            bestCost = cost;
+            best = static_cast<int>(i);
+        }
+    }
+    if (best < 0)
+        return {};
+    logInfo("Tower", "Portfolio search: best tour from strategy " + std::to_string(best) + " out of " + std::to_string(tours.size()) +
+                     " on " + std::to_string(threads) + " threads in " + std::to_string(rounds) + " rounds");
+    return tours[best];
+}
+
+template <int Side>
+std::vector<std::pair<std::shared_ptr<BasicSector<Side>>, typename BasicCerebrum<Side>::Waypoints>>
+BasicCerebrum<Side>::replanSectors(const std::vector<int> &sectorIDs, const std::chrono::milliseconds timeLimit) const {
+    std::vector<std::pair<std::shared_ptr<BasicSector<Side>>, Waypoints>> updates;
+    const auto [firstSolution, metaheuristic] = portfolioStrategies.front();
+
+    for (const int sectorID : sectorIDs) {
+        const auto it = std::find_if(sectors.begin(), sectors.end(), [sectorID](const auto &sector) { return sector->getSectorID() == sectorID; });
+        if (it == sectors.end()) {
+            logWarning("Tower", "Cannot re-plan unknown sector " + std::to_string(sectorID));
+            continue;
+        }
+        const auto &sector = *it;
+        const Waypoints &positions = sector->getWaypoints();
+        const DistanceMatrix distance_matrix(positions.data(), positions.size());
 
+        // Recover the current tour as waypoint indices, it seeds the search
+        std::vector<int> current;
+        for (const Position &point : sector->getTSP()) {
+            const auto match = std::find_if(positions.begin(), positions.end(), [&point](const Position &waypoint) {
+                return std::abs(waypoint.x - point.x) < 1e-3 && std::abs(waypoint.y - point.y) < 1e-3;
+            });
+            if (match == positions.end())
+                break;
+            current.push_back(static_cast<int>(match - positions.begin()));
+        }
+        const bool seeded = current.size() == positions.size() && current.front() == sector->getStartingIndex();
+
+        const std::vector<int> tour = runSearch(distance_matrix, sector->getStartingIndex(), firstSolution, metaheuristic,
+                                                std::chrono::steady_clock::now() + timeLimit, seeded ? &current : nullptr);
+        if (tour.size() != positions.size() || (seeded && tourCost(distance_matrix, tour) >= tourCost(distance_matrix, current)))
+            continue; // Nothing better than what the drones are already flying
+
+        Waypoints relativePath{};
+        for (int i = 0; i < Geometry::cells; ++i)
+            relativePath[i] = positions[tour[i]] - sector->getStartingPoint();
+        updates.emplace_back(sector, relativePath);
+    }
+    logInfo("Tower", "Re-planned " + std::to_string(sectorIDs.size()) + " sectors, " + std::to_string(updates.size()) + " paths changed");
+    return updates;
+}
+
+template <int Side>
+void BasicCerebrum<Side>::solveTSP(const Waypoints &positions, const int starting_index) {
+    const Position starting_position = positions[starting_index];
+
+    // Same layout, starting point and solver as a previous run: reuse its tour
+    const uint64_t cacheKey = TourCache::key(positions.data(), positions.size(), starting_index, static_cast<uint32_t>(backend));
+    std::vector<int> tour;
+    if (auto cached = tourCache.lookup(cacheKey, positions.size(), starting_index)) {
+        tour = std::move(*cached);
+        logInfo("Tower", "TSP tour loaded from cache");
+    } else {
+        if (backend == SolverBackend::Auto && isCanonicalLayout<Side>(positions)) {
+            // Sectors built by WatchZone: the optimal tour is known at compile time
+            const int region = static_cast<int>(std::find(Geometry::startingIndex.begin(), Geometry::startingIndex.end(), starting_index) - Geometry::startingIndex.begin());
+            if (region < 4) {
+                tour.assign(Geometry::canonicalTours[region].begin(), Geometry::canonicalTours[region].end());
+                logInfo("Tower", "TSP tour taken from the canonical " + std::to_string(Side) + "x" + std::to_string(Side) + " sector");
+            }
+        }
+        if (backend == SolverBackend::Auto && tour.empty()) {
+            // Regular sectors are solved directly on the lattice
+            if (const LatticeSolver lattice({positions.begin(), positions.end()}); lattice.isLattice()) {
+                tour = lattice.solve(starting_index);
+                logInfo("Tower", "TSP solved on " + std::to_string(lattice.getRows()) + "x" + std::to_string(lattice.getCols()) + " lattice");
+            } else {
+                logWarning("Tower", "Waypoints are not a regular lattice, falling back to OR-tools");
+            }
+        }
+        if (tour.empty())
+            tour = backend == SolverBackend::OrTools ? solveWithOrTools(positions, starting_index) : solveWithPortfolio(positions, starting_index);
+        if (tour.size() == positions.size())
+            tourCache.store(cacheKey, tour);
+    }
+
+    if (tour.size() == positions.size()) {
         //visualizeTour(tour, positions);
 
         // Apply transformations for other sectors
-        for (int i = 0; i < 100; ++i) {
-            RoutingNodeIndex node = tour[i];
-            Position offset = positions[node.value()] - starting_position;
+        for (int i = 0; i < Geometry::cells; ++i) {
+            Position offset = positions[tour[i]] - starting_position;
             relativeTSPPaths[0][i] = offset;
             relativeTSPPaths[1][i] = {-offset.x, offset.y};
             relativeTSPPaths[2][i] = {offset.x, -offset.y};
@@ -177,3 +351,10 @@ void Cerebrum::solveTSP(const std::array<Position, 100> &positions, int starting
     }
 
 }
+
+template class BasicCerebrum<5>;
+template class BasicCerebrum<10>;
+template class BasicCerebrum<20>;
+#if SKYWATCHER_SECTOR_SIDE != 5 && SKYWATCHER_SECTOR_SIDE != 10 && SKYWATCHER_SECTOR_SIDE != 20
+template class BasicCerebrum<SKYWATCHER_SECTOR_SIDE>;
+#endif
@@ -4,10 +4,16 @@
 #include <unordered_map>
 #include <vector>
 #include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <nlohmann/json.hpp>
 #include "Utils/Structs.h"
 #include "Utils/GridDefinitions.h"
 #include "Utils/Logger.h"
+#include "LatticeSolver.h"
+#include "TourCache.h"
+#include "DistanceMatrix.h"
 #include <SFML/Graphics.hpp>
 #include <ortools/constraint_solver/routing.h>
 #include <ortools/constraint_solver/routing_enums.pb.h>
@@ -16,18 +22,49 @@
 #include <ortools/constraint_solver/constraint_solver.h>
 
 
-class Cerebrum {
+// Backend used to solve the sector tour
+enum class SolverBackend {
+    Auto,       // Lattice solver for regular sectors, OR-tools portfolio for irregular inputs
+    OrTools,    // Always run a single OR-tools search
+    Portfolio   // Always run the parallel OR-tools portfolio
+};
+
+// Plans the patrol path of Side x Side sectors
+// Instantiated in Cerebrum.cpp for 5x5, 10x10, 20x20 and the configured SKYWATCHER_SECTOR_SIDE
+template <int Side>
+class BasicCerebrum {
+public:
+    using Geometry = SectorGeometry<Side>;
+    using Waypoints = typename Geometry::Waypoints;
+
 private:
-    std::vector<std::shared_ptr<Sector>> sectors;
-    std::array<std::array<Position, 100>, 4> relativeTSPPaths{};
+    std::vector<std::shared_ptr<BasicSector<Side>>> sectors;
+    std::array<Waypoints, 4> relativeTSPPaths{};
+    SolverBackend backend;
+    TourCache tourCache;
 
-    std::array<std::array<int, 100>, 100> ComputeDistanceMatrix(const std::array<Position, 100> &positions);
     void fillCheckPoints();
 public:
-    explicit Cerebrum(const std::vector<std::shared_ptr<Sector>> &sectors);
+    explicit BasicCerebrum(const std::vector<std::shared_ptr<BasicSector<Side>>> &sectors, SolverBackend backend = SolverBackend::Auto,
+                           const std::string &tourCachePath = "tour_cache.bin");
     // TSP solver implementation
-    void solveTSP(const std::array<Position, 100> &positions, int starting_index);
+    void solveTSP(const Waypoints &positions, int starting_index);
+
+    // OR-tools guided local search, returns the tour as waypoint indices starting from starting_index (empty if none found)
+    static std::vector<int> solveWithOrTools(const Waypoints &positions, int starting_index, int timeLimitSeconds = 3);
+
+    // Re-plans the given sectors, seeding OR-tools with each sector's current tour.
+    // Returns the new relative path of the sectors whose tour actually improved, the sectors themselves are left untouched
+    [[nodiscard]] std::vector<std::pair<std::shared_ptr<BasicSector<Side>>, Waypoints>> replanSectors(
+            const std::vector<int> &sectorIDs, std::chrono::milliseconds timeLimit = std::chrono::milliseconds(500)) const;
+
+    // Runs OR-tools searches with different first-solution strategies and metaheuristics in parallel (threads = 0: one per core)
+    // and returns the shortest tour (ties broken by strategy order). With fewer threads than strategies they run in rounds,
+    // each search gets an equal share of the time limit so every strategy runs
+    static std::vector<int> solveWithPortfolio(const Waypoints &positions, int starting_index, int timeLimitSeconds = 3, unsigned threads = 0);
 };
 
+using Cerebrum = BasicCerebrum<SKYWATCHER_SECTOR_SIDE>;
+
 
 #endif //SKYWATCHER_CEREBRUM_H
@@ -0,0 +1,74 @@
+#include "DistanceMatrix.h"
+#include <cmath>
+
+// The AVX2 kernel is built with a per-function target attribute and selected at runtime,
+// so the binary still runs on CPUs without AVX2
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SKYWATCHER_HAS_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+DistanceMatrix::DistanceMatrix(const Position *positions, const std::size_t count, const int scale)
+    : size(static_cast<int>(count)), scale(scale), packed(count * (count + 1) / 2, 0) {
+    // Structure-of-arrays copy so each row is computed from contiguous coordinates
+    std::vector<double> xs(count), ys(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        xs[i] = positions[i].x;
+        ys[i] = positions[i].y;
+    }
+
+    if (usesAvx2())
+        computeAvx2(xs, ys);
+    else
+        computeScalar(xs, ys);
+}
+
+void DistanceMatrix::computeScalar(const std::vector<double> &xs, const std::vector<double> &ys) {
+    for (int i = 1; i < size; ++i) {
+        int32_t *row = packed.data() + static_cast<std::size_t>(i) * (i + 1) / 2;
+        for (int j = 0; j < i; ++j) {
+            const double dx = xs[i] - xs[j];
+            const double dy = ys[i] - ys[j];
+            row[j] = static_cast<int32_t>(std::sqrt(dx * dx + dy * dy) * scale);
+        }
+    }
+}
+
+#ifdef SKYWATCHER_HAS_AVX2_KERNEL
+__attribute__((target("avx2")))
+void DistanceMatrix::computeAvx2(const std::vector<double> &xs, const std::vector<double> &ys) {
+    const __m256d factor = _mm256_set1_pd(scale);
+    for (int i = 1; i < size; ++i) {
+        int32_t *row = packed.data() + static_cast<std::size_t>(i) * (i + 1) / 2;
+        const __m256d xi = _mm256_set1_pd(xs[i]);
+        const __m256d yi = _mm256_set1_pd(ys[i]);
+
+        // Four distances per iteration, scaled and truncated to int32 in registers
+        int j = 0;
+        for (; j + 4 <= i; j += 4) {
+            const __m256d dx = _mm256_sub_pd(xi, _mm256_loadu_pd(xs.data() + j));
+            const __m256d dy = _mm256_sub_pd(yi, _mm256_loadu_pd(ys.data() + j));
+            const __m256d dist = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + j), _mm256_cvttpd_epi32(_mm256_mul_pd(dist, factor)));
+        }
+        for (; j < i; ++j) {
+            const double dx = xs[i] - xs[j];
+            const double dy = ys[i] - ys[j];
+            row[j] = static_cast<int32_t>(std::sqrt(dx * dx + dy * dy) * scale);
+        }
+    }
+}
+
+bool DistanceMatrix::usesAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#else
+void DistanceMatrix::computeAvx2(const std::vector<double> &xs, const std::vector<double> &ys) {
+    computeScalar(xs, ys);
+}
+
+bool DistanceMatrix::usesAvx2() {
+    return false;
+}
+#endif
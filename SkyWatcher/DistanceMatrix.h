@@ -0,0 +1,37 @@
+#ifndef SKYWATCHER_DISTANCEMATRIX_H
+#define SKYWATCHER_DISTANCEMATRIX_H
+
+#include <cstdint>
+#include <vector>
+#include "Utils/Structs.h"
+
+// Symmetric matrix of integer-scaled distances (metres * scale, truncated) between waypoints.
+// Only the lower triangle and the zero diagonal are stored, row by row in a single flat array:
+// row i starts at i * (i + 1) / 2 and holds the distances to waypoints 0..i
+class DistanceMatrix {
+private:
+    int size;
+    int scale;
+    std::vector<int32_t> packed;
+
+    void computeScalar(const std::vector<double> &xs, const std::vector<double> &ys);
+    void computeAvx2(const std::vector<double> &xs, const std::vector<double> &ys);
+
+public:
+    DistanceMatrix(const Position *positions, std::size_t count, int scale = 1000);
+
+    [[nodiscard]] int32_t operator()(const int from, const int to) const {
+        const int row = from > to ? from : to;
+        const int col = from > to ? to : from;
+        return packed[static_cast<std::size_t>(row) * (row + 1) / 2 + col];
+    }
+
+    [[nodiscard]] int getSize() const { return size; }
+    [[nodiscard]] int getScale() const { return scale; }
+
+    // True if the AVX2 kernel is compiled in and supported by this CPU
+    static bool usesAvx2();
+};
+
+
+#endif //SKYWATCHER_DISTANCEMATRIX_H
@@ -0,0 +1,157 @@
+#include "LatticeSolver.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr double tolerance = 1e-3;      // Coordinates closer than 1mm are considered equal
+    constexpr int maxPasses = 50;           // Upper bound on polish iterations
+
+    // Sorted distinct values of a coordinate, merging values within tolerance
+    std::vector<double> distinctValues(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        std::vector<double> distinct;
+        for (const double v : values) {
+            if (distinct.empty() || v - distinct.back() > tolerance)
+                distinct.push_back(v);
+        }
+        return distinct;
+    }
+
+    // Check that consecutive values share the same step and return it (0 if the spacing is not uniform)
+    double uniformStep(const std::vector<double> &values) {
+        if (values.size() < 2)
+            return 0;
+        const double step = values[1] - values[0];
+        for (size_t i = 2; i < values.size(); ++i) {
+            if (std::abs(values[i] - values[i - 1] - step) > tolerance)
+                return 0;
+        }
+        return step;
+    }
+}
+
+LatticeSolver::LatticeSolver(std::vector<Position> p) : positions(std::move(p)), rows(0), cols(0), lattice(false), distances(nullptr, 0) {
+    std::vector<double> xs, ys;
+    xs.reserve(positions.size());
+    ys.reserve(positions.size());
+    for (const auto &pos : positions) {
+        xs.push_back(pos.x);
+        ys.push_back(pos.y);
+    }
+    const std::vector<double> columns = distinctValues(std::move(xs));
+    const std::vector<double> lines = distinctValues(std::move(ys));
+
+    if (columns.size() * lines.size() != positions.size())
+        return;
+    const double stepX = uniformStep(columns);
+    const double stepY = uniformStep(lines);
+    if (stepX <= 0 || stepY <= 0)
+        return;
+
+    rows = static_cast<int>(lines.size());
+    cols = static_cast<int>(columns.size());
+    nodeAt.assign(positions.size(), -1);
+    for (int i = 0; i < static_cast<int>(positions.size()); ++i) {
+        const int col = static_cast<int>(std::lround((positions[i].x - columns.front()) / stepX));
+        const int row = static_cast<int>(std::lround((positions[i].y - lines.front()) / stepY));
+        int &slot = nodeAt[row * cols + col];
+        if (slot != -1)
+            return; // Two waypoints on the same lattice point
+        slot = i;
+    }
+    lattice = true;
+    distances = DistanceMatrix(positions.data(), positions.size());
+}
+
+std::vector<int> LatticeSolver::solve(const int starting_index) const {
+    if (!lattice)
+        return {};
+
+    std::vector<int> cycle(positions.size());
+    geometry::serpentineCycle(rows, cols, cycle.data());
+
+    std::vector<int> tour(cycle.size());
+    std::transform(cycle.begin(), cycle.end(), tour.begin(), [this](const int cell) { return nodeAt[cell]; });
+
+    // A cycle can start anywhere: rotate it so the drone begins from the sector's starting point
+    std::rotate(tour.begin(), std::find(tour.begin(), tour.end(), starting_index), tour.end());
+
+    polish(tour);
+    return tour;
+}
+
+void LatticeSolver::polish(std::vector<int> &tour) const {
+    if (tour.size() < 4)
+        return;
+    for (int pass = 0; pass < maxPasses; ++pass) {
+        twoOpt(tour);
+        if (!orOpt(tour))
+            break;
+    }
+}
+
+// Reverse segments while it shortens the tour, tour[0] never moves
+void LatticeSolver::twoOpt(std::vector<int> &tour) const {
+    const int n = static_cast<int>(tour.size());
+    bool improved = true;
+    for (int pass = 0; improved && pass < maxPasses; ++pass) {
+        improved = false;
+        for (int i = 0; i < n - 2; ++i) {
+            const int a = tour[i], b = tour[i + 1];
+            const int64_t ab = distances(a, b);
+            for (int j = i + 2; j < n; ++j) {
+                if (i == 0 && j == n - 1)
+                    continue; // Adjacent edges through the start
+                const int c = tour[j], d = tour[(j + 1) % n];
+                if (static_cast<int64_t>(distances(a, c)) + distances(b, d) - ab - distances(c, d) < 0) {
+                    std::reverse(tour.begin() + i + 1, tour.begin() + j + 1);
+                    improved = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Move chains of 1 to 3 waypoints to a cheaper position (optionally reversed), returns true if something moved
+bool LatticeSolver::orOpt(std::vector<int> &tour) const {
+    const int n = static_cast<int>(tour.size());
+    bool moved = false;
+    for (int len = 1; len <= 3; ++len) {
+        for (int i = 1; i + len <= n; ++i) {
+            const int first = tour[i], last = tour[i + len - 1];
+            const int prev = tour[i - 1], next = tour[(i + len) % n];
+            const int64_t removeGain = static_cast<int64_t>(distances(prev, first)) + distances(last, next) - distances(prev, next);
+
+            for (int j = 0; j < n; ++j) {
+                if (j >= i - 1 && j <= i + len - 1)
+                    continue; // Edge touches the chain itself
+                const int a = tour[j], b = tour[(j + 1) % n];
+                const int64_t ab = distances(a, b);
+                const int64_t forward = static_cast<int64_t>(distances(a, first)) + distances(last, b) - ab;
+                const int64_t reversed = static_cast<int64_t>(distances(a, last)) + distances(first, b) - ab;
+                if (std::min(forward, reversed) < removeGain) {
+                    std::vector<int> chain(tour.begin() + i, tour.begin() + i + len);
+                    if (reversed < forward)
+                        std::reverse(chain.begin(), chain.end());
+                    tour.erase(tour.begin() + i, tour.begin() + i + len);
+                    const auto at = std::find(tour.begin(), tour.end(), a) + 1;
+                    tour.insert(at, chain.begin(), chain.end());
+                    moved = true;
+                    break;
+                }
+            }
+        }
+    }
+    return moved;
+}
+
+double LatticeSolver::tourLength(const std::vector<int> &tour, const std::vector<Position> &positions) {
+    double length = 0;
+    for (size_t i = 0; i < tour.size(); ++i) {
+        const Position &from = positions[tour[i]];
+        const Position &to = positions[tour[(i + 1) % tour.size()]];
+        length += std::sqrt((to.x - from.x) * (to.x - from.x) + (to.y - from.y) * (to.y - from.y));
+    }
+    return length;
+}
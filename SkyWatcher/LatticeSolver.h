@@ -0,0 +1,41 @@
+#ifndef SKYWATCHER_LATTICESOLVER_H
+#define SKYWATCHER_LATTICESOLVER_H
+
+#include <vector>
+#include "Utils/SectorGeometry.h"
+#include "DistanceMatrix.h"
+
+// Coverage-path solver for waypoints laid out on a regular lattice.
+// Builds a boustrophedon (serpentine) cycle directly from the lattice and polishes it with 2-opt/Or-opt,
+// so a regular sector is solved in microseconds instead of running a full OR-tools search
+class LatticeSolver {
+private:
+    std::vector<Position> positions;
+    std::vector<int> nodeAt;        // Lattice cell (row * cols + col) -> waypoint index
+    int rows, cols;
+    bool lattice;
+    DistanceMatrix distances;       // Only computed once the input is known to be a lattice
+
+    void twoOpt(std::vector<int> &tour) const;
+    bool orOpt(std::vector<int> &tour) const;
+
+public:
+    explicit LatticeSolver(std::vector<Position> positions);
+
+    // True if the waypoints form a complete rows x cols lattice with uniform spacing on each axis
+    [[nodiscard]] bool isLattice() const { return lattice; }
+    [[nodiscard]] int getRows() const { return rows; }
+    [[nodiscard]] int getCols() const { return cols; }
+
+    // Returns the closed tour as waypoint indices, starting from starting_index (empty if not a lattice)
+    [[nodiscard]] std::vector<int> solve(int starting_index) const;
+
+    // Improve an existing tour in place, keeping tour[0] fixed
+    void polish(std::vector<int> &tour) const;
+
+    // Length of the closed tour in metres
+    static double tourLength(const std::vector<int> &tour, const std::vector<Position> &positions);
+};
+
+
+#endif //SKYWATCHER_LATTICESOLVER_H
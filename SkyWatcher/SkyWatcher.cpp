@@ -1,25 +1,46 @@
 #include "WatchZone.h"
+#include "Utils/CommandLine.h"
 
 int main(const int argc, char* argv[]) {
     // logOpen("tower - " + getCurrentTime() + ".log");
     const std::string logFile = "tower.log"; // adjust the filename to be unique using timestamp di needed
     openLogFiles(logFile);
     logInfo("Tower", "Initializing...");
-    if (argc == 1 || argc > 4) {
-        logError("Tower", "Invalid number of arguments. Usage: ./tower [areaSize] [timeScale]");
+    const CommandLine commandLine(argc, argv);
+    const auto &args = commandLine.positional();
+    if (args.empty() || args.size() > 2) {
+        logError("Tower", "Invalid number of arguments. Usage: ./tower [areaSize] [timeScale] [--events] [--json] [--inline-paths] [--handshake-workers=N]");
         return 1;
     }
-    if (argc == 2) {
-        logInfo("Tower", "Starting tower with area size: " + std::string(argv[1]) + " and default time scale: 10");
 
-        WatchZone watchZone(std::stoi(argv[1]), 10);
+    TowerOptions options;
+    // --events: track drones from pushed statuses and key expirations instead of polling every status key
+    if (commandLine.has("events")) {
+        options.monitorMode = MonitorMode::EventDriven;
+        logInfo("Tower", "Event-driven drone monitoring enabled");
     }
-    if (argc == 3) {
-        logInfo("Tower", "Starting tower with area size: " + std::string(argv[1]) + " and time scale: " + std::string(argv[2]));
-        WatchZone watchZone(std::stoi(argv[1]), std::stoi(argv[2]));
+    // --json: send init and command messages as JSON instead of the binary wire format, for debugging
+    if (commandLine.has("json")) {
+        options.encoding = wire::Encoding::Json;
+        logInfo("Tower", "JSON wire format enabled");
+    }
+    // --inline-paths: embed the full patrol path in every handoff instead of a reference to a stored tour
+    if (commandLine.has("inline-paths")) {
+        options.inlinePaths = true;
+        logInfo("Tower", "Inline patrol paths enabled");
+    }
+    // --handshake-workers=N: threads initializing connecting drones, one per core by default
+    if (commandLine.has("handshake-workers")) {
+        options.handshakeWorkers = std::stoul(commandLine.value("handshake-workers", "0"));
+        logInfo("Tower", "Handshake workers: " + std::to_string(options.handshakeWorkers));
+    }
+
+    if (args.size() == 1) {
+        logInfo("Tower", "Starting tower with area size: " + args[0] + " and default time scale: 10");
+        WatchZone watchZone(std::stoi(args[0]), 10, options);
     } else {
-        logInfo("Tower", "Starting tower with default area size: 1200 and default time scale: 10");
-        WatchZone watchZone(800, 10);
+        logInfo("Tower", "Starting tower with area size: " + args[0] + " and time scale: " + args[1]);
+        WatchZone watchZone(std::stoi(args[0]), std::stoi(args[1]), options);
     }
     closeLogFiles();
-}
\ No newline at end of file
+}
@@ -0,0 +1,204 @@
+#include "TourCache.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "Utils/Logger.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    constexpr char magic[4] = {'S', 'W', 'T', 'C'};
+    constexpr uint64_t fnvOffset = 14695981039346656037ull;
+    constexpr uint64_t fnvPrime = 1099511628211ull;
+
+    uint64_t fnv1a(const unsigned char *data, const std::size_t size, uint64_t hash = fnvOffset) {
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= data[i];
+            hash *= fnvPrime;
+        }
+        return hash;
+    }
+
+    void putU32(std::vector<unsigned char> &out, const uint32_t value) {
+        for (int i = 0; i < 4; ++i)
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+
+    void putU64(std::vector<unsigned char> &out, const uint64_t value) {
+        for (int i = 0; i < 8; ++i)
+            out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+
+    // Sequential little-endian reader, fails (instead of reading past the end) on truncated input
+    struct Reader {
+        const std::vector<unsigned char> &data;
+        std::size_t offset = 0;
+
+        bool u32(uint32_t &value) {
+            if (data.size() - offset < 4) return false;
+            value = 0;
+            for (int i = 0; i < 4; ++i)
+                value |= static_cast<uint32_t>(data[offset++]) << (8 * i);
+            return true;
+        }
+
+        bool u64(uint64_t &value) {
+            if (data.size() - offset < 8) return false;
+            value = 0;
+            for (int i = 0; i < 8; ++i)
+                value |= static_cast<uint64_t>(data[offset++]) << (8 * i);
+            return true;
+        }
+    };
+
+    // Flush a written file to the disk
+    bool syncFile(std::FILE *file) {
+        if (std::fflush(file) != 0)
+            return false;
+    #if defined(_WIN32) || defined(_WIN64)
+        return _commit(_fileno(file)) == 0;
+    #else
+        return fsync(fileno(file)) == 0;
+    #endif
+    }
+
+    // Make a rename in directory durable. Windows has no directory handles to sync, its renames are journaled
+    bool syncDirectory(const std::string &directory) {
+    #if defined(_WIN32) || defined(_WIN64)
+        return true;
+    #else
+        const int fd = open(directory.c_str(), O_RDONLY);
+        if (fd == -1)
+            return false;
+        const bool synced = fsync(fd) == 0;
+        close(fd);
+        return synced;
+    #endif
+    }
+}
+
+TourCache::TourCache(std::string path) : path(std::move(path)) {
+    load();
+}
+
+uint64_t TourCache::key(const Position *positions, const std::size_t count, const int starting_index, const uint32_t solver) {
+    std::vector<unsigned char> bytes;
+    bytes.reserve(12 + count * 16);
+    putU32(bytes, static_cast<uint32_t>(count));
+    putU32(bytes, static_cast<uint32_t>(starting_index));
+    putU32(bytes, solver);
+    for (std::size_t i = 0; i < count; ++i) {
+        uint64_t x, y;
+        std::memcpy(&x, &positions[i].x, sizeof(x));
+        std::memcpy(&y, &positions[i].y, sizeof(y));
+        putU64(bytes, x);
+        putU64(bytes, y);
+    }
+    return fnv1a(bytes.data(), bytes.size());
+}
+
+std::optional<std::vector<int>> TourCache::lookup(const uint64_t key, const std::size_t count, const int starting_index) const {
+    const auto it = tours.find(key);
+    if (it == tours.end())
+        return std::nullopt;
+
+    // Never trust the file blindly: the tour must visit every waypoint exactly once
+    const std::vector<int> &tour = it->second;
+    if (tour.empty() || tour.size() != count || tour.front() != starting_index)
+        return std::nullopt;
+    std::vector<bool> visited(count, false);
+    for (const int node : tour) {
+        if (node < 0 || static_cast<std::size_t>(node) >= count || visited[node])
+            return std::nullopt;
+        visited[node] = true;
+    }
+    return tour;
+}
+
+void TourCache::store(const uint64_t key, const std::vector<int> &tour) {
+    tours[key] = tour;
+    if (!save())
+        logWarning("Tower", "Unable to write tour cache " + path);
+}
+
+void TourCache::load() {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return;
+    const std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Header and trailing checksum
+    if (data.size() < sizeof(magic) + 16 || std::memcmp(data.data(), magic, sizeof(magic)) != 0) {
+        logWarning("Tower", "Ignoring invalid tour cache " + path);
+        return;
+    }
+    Reader reader{data, data.size() - 8};
+    uint64_t checksum;
+    reader.u64(checksum);
+    if (checksum != fnv1a(data.data(), data.size() - 8)) {
+        logWarning("Tower", "Ignoring corrupted tour cache " + path);
+        return;
+    }
+
+    reader.offset = sizeof(magic);
+    uint32_t fileVersion, entries;
+    reader.u32(fileVersion);
+    if (fileVersion != version) {
+        logInfo("Tower", "Ignoring tour cache with version " + std::to_string(fileVersion));
+        return;
+    }
+    reader.u32(entries);
+
+    std::unordered_map<uint64_t, std::vector<int>> loaded;
+    for (uint32_t e = 0; e < entries; ++e) {
+        uint64_t key;
+        uint32_t length;
+        if (!reader.u64(key) || !reader.u32(length) || (data.size() - 8 - reader.offset) / 4 < length) {
+            logWarning("Tower", "Ignoring truncated tour cache " + path);
+            return;
+        }
+        std::vector<int> tour(length);
+        for (auto &node : tour) {
+            uint32_t value;
+            reader.u32(value);
+            node = static_cast<int>(value);
+        }
+        loaded[key] = std::move(tour);
+    }
+    tours = std::move(loaded);
+    logInfo("Tower", "Loaded " + std::to_string(tours.size()) + " tours from cache " + path);
+}
+
+bool TourCache::save() const {
+    std::vector<unsigned char> data(std::begin(magic), std::end(magic));
+    putU32(data, version);
+    putU32(data, static_cast<uint32_t>(tours.size()));
+    for (const auto &[key, tour] : tours) {
+        putU64(data, key);
+        putU32(data, static_cast<uint32_t>(tour.size()));
+        for (const int node : tour)
+            putU32(data, static_cast<uint32_t>(node));
+    }
+    putU64(data, fnv1a(data.data(), data.size()));
+
+    // Readers either see the old file or the complete new one, never a partial write, even after a crash: the data
+    // reaches the disk before the rename, and the rename before returning
+    const std::string temporary = path + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+    const bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size() && syncFile(file);
+    if (std::fclose(file) != 0 || !written)
+        return false;
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+        return false;
+    const std::string directory = std::filesystem::path(path).parent_path().string();
+    return syncDirectory(directory.empty() ? "." : directory);
+}
@@ -0,0 +1,39 @@
+#ifndef SKYWATCHER_TOURCACHE_H
+#define SKYWATCHER_TOURCACHE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Utils/Structs.h"
+
+// Persistent cache of solved sector tours, keyed by a hash of the waypoint layout, the starting index and the solver.
+// File layout (little-endian): "SWTC" | version u32 | entries u32 | {key u64, length u32, node u32 * length} * entries | FNV-1a u64
+class TourCache {
+private:
+    static constexpr uint32_t version = 2;     // Bump whenever the stored tour format or the key changes
+
+    std::string path;
+    std::unordered_map<uint64_t, std::vector<int>> tours;
+
+    void load();
+    [[nodiscard]] bool save() const;
+
+public:
+    explicit TourCache(std::string path = "tour_cache.bin");
+
+    // Hash of the waypoint coordinates, starting index and solver (tours of different solvers are kept apart, so
+    // switching solver never returns the other one's tour)
+    static uint64_t key(const Position *positions, std::size_t count, int starting_index, uint32_t solver);
+
+    // Cached tour for key, only if it is a valid tour of count waypoints starting from starting_index
+    [[nodiscard]] std::optional<std::vector<int>> lookup(uint64_t key, std::size_t count, int starting_index) const;
+
+    // Add a tour and rewrite the cache file atomically and durably (write and sync a temporary file, rename it, then
+    // sync the directory)
+    void store(uint64_t key, const std::vector<int> &tour);
+};
+
+
+#endif //SKYWATCHER_TOURCACHE_H
@@ -4,26 +4,15 @@
 std::vector<std::shared_ptr<Sector>> WatchZone::createSectors()
 {
     logInfo("Tower", "Creating sectors...");
-    constexpr float cellSize = 20; // Assuming 20m x 20m cells
-    constexpr size_t cellsPerSector = 10; // 10x10 cells per sector
+    constexpr float cellSize = CELL_SIZE; // 20m x 20m cells
+    constexpr size_t cellsPerSector = Sector::Geometry::side; // Side x Side cells per sector
     constexpr auto sectorSize = static_cast<size_t>(cellsPerSector * cellSize);
 
-    this->numRows = static_cast<std::size_t>(std::ceil(this->height / cellSize));
-    this->numCols = static_cast<std::size_t>(std::ceil(this->width / cellSize));
+    this->numRows = grid.getRows();
+    this->numCols = grid.getCols();
 
-    std::vector allCells(numRows, std::vector<std::shared_ptr<Cell>>(numCols));
-    // Vector not needed use std::array instead
-
-    for (int i = 0; i < height / cellSize; i++)
-    {
-        for (int j = 0; j < width / cellSize; j++)
-        {
-            allCells[i][j] = std::make_shared<Cell>(j * cellSize, (j + 1) * cellSize, i * cellSize, (i + 1) * cellSize);
-        }
-    }
-
-    this->numCols/=10;
-    this->numRows/=10;
+    this->numCols/=cellsPerSector;
+    this->numRows/=cellsPerSector;
 
     std::vector<std::shared_ptr<Sector>> sectors;
     sectors.reserve(numCols * numRows); // Change this to be dynamic
@@ -34,7 +23,7 @@ std::vector<std::shared_ptr<Sector>> WatchZone::createSectors()
         {
             int startX = static_cast<int>(x / cellSize);
             int startY = static_cast<int>(y / cellSize);
-            sectors.emplace_back(std::make_shared<Sector>(sectorID++, startX, startY, allCells, this->height));
+            sectors.emplace_back(std::make_shared<Sector>(sectorID++, startX, startY, grid, this->height));
         }
     }
     logInfo("Tower", "Sectors created");
@@ -62,24 +51,25 @@ sf::Vector2f WatchZone::scalePosition(const double x, const double y) const
 
 void WatchZone::drawGrid(sf::RenderWindow& window) const
 {
+    constexpr int side = Sector::Geometry::side;
     // Draw cells' line
     const auto cellColor = sf::Color(200, 200,200); // Light gray color for grid lines
     // Create vertical lines
-    for (int i = 0; i <= numCols*10; ++i)
+    for (int i = 0; i <= numCols*side; ++i)
     {
         const sf::Vertex line[] = {
-            sf::Vertex(sf::Vector2f(i * cellWidth/10, 0), cellColor),
-            sf::Vertex(sf::Vector2f(i * cellWidth/10, windowHeight), cellColor)
+            sf::Vertex(sf::Vector2f(i * cellWidth/side, 0), cellColor),
+            sf::Vertex(sf::Vector2f(i * cellWidth/side, windowHeight), cellColor)
         };
         window.draw(line, 2, sf::Lines);
     }
 
     // Create horizontal lines
-    for (int i = 0; i <= numRows*10; ++i)
+    for (int i = 0; i <= numRows*side; ++i)
     {
         const sf::Vertex line[] = {
-            sf::Vertex(sf::Vector2f(0, i * cellHeight/10), cellColor),
-            sf::Vertex(sf::Vector2f(windowWidth, i * cellHeight/10), cellColor)
+            sf::Vertex(sf::Vector2f(0, i * cellHeight/side), cellColor),
+            sf::Vertex(sf::Vector2f(windowWidth, i * cellHeight/side), cellColor)
         };
         window.draw(line, 2, sf::Lines);
     }
@@ -169,14 +159,30 @@ void WatchZone::visualizationThread(TowerClient& tower_client, const std::vector
         //drawSectorLabels(window, font);
 
         // Get the latest drone statuses
-        auto drone_statuses = tower_client.get_drone_statuses();
+        const auto fleet = tower_client.get_fleet_snapshot();
+
+        // Highlight the cell each monitoring drone is watching
+        constexpr int side = Sector::Geometry::side;
+        const sf::Vector2f cellSize(cellWidth / side, cellHeight / side);
+        for (const auto& status : fleet->drones)
+        {
+            if (status.state != DroneState::Monitoring)
+                continue;
+            const GridLocation location = grid.locate(status.position);
+            if (location.cellIndex == -1)
+                continue;
+            sf::RectangleShape cell_shape(cellSize);
+            cell_shape.setPosition(sf::Vector2f(location.cellX * cellSize.x, location.cellY * cellSize.y));
+            cell_shape.setFillColor(sf::Color(170, 200, 255));
+            window.draw(cell_shape);
+        }
 
         // Process and draw drone positions
-        for (const auto& [drone_id, status] : drone_statuses)
+        for (const auto& status : fleet->drones)
         {
-            double x = status["position"]["x"];
-            double y = status["position"]["y"];
-            double battery = status["battery_level"];
+            double x = status.position.x;
+            double y = status.position.y;
+            double battery = status.batteryLevel;
 
             // Scale positions to window size
             sf::Vector2f position = scalePosition(x, y);
@@ -200,16 +206,18 @@ void WatchZone::visualizationThread(TowerClient& tower_client, const std::vector
         // Display the window
         window.display();
 
-        std::this_thread::sleep_for(std::chrono::duration<float>(0.1 / timeScale));
+        std::this_thread::sleep_for(clock->duration(0.1));
     }
 }
 
-WatchZone::WatchZone(const int areaSize, const int timeScale = 1)
+WatchZone::WatchZone(const int areaSize, const int timeScale = 1, const TowerOptions& options = {})
     : width(areaSize), height(areaSize), timeScale(timeScale),
+      grid(areaSize, areaSize),
       sectors(createSectors()), // Initialize sectors using the new method
       cerebrum(sectors), // Initialize cerebrum with the newly created sectors
       redisCommunication("127.0.0.1", 6379),
-      client(redisCommunication.get_redis_instance(), sectors, timeScale, center)
+      clock(std::make_shared<RealClock>(timeScale)),
+      client(redisCommunication.get_redis_instance(), sectors, grid, clock, center, options)
 {
     // Listen for drone connections
     client.start_listening_for_drones();
@@ -218,7 +226,7 @@ WatchZone::WatchZone(const int areaSize, const int timeScale = 1)
 
     std::this_thread::sleep_for(std::chrono::seconds(1));
     // Look for disconnected drones
-    client.start_monitoring_drones();
+    client.start_monitoring_drones(options.monitorMode);
     std::cout << "Monitoring drones..." << std::endl;
     logInfo("Tower", "Start monitoring drones...");
 
@@ -226,5 +234,13 @@ WatchZone::WatchZone(const int areaSize, const int timeScale = 1)
     std::cout << "Listening for substitution messages..." << std::endl;
     logInfo("Tower", "Start listening for drone substitution requests...");
 
+    client.start_assignment_engine();
+    logInfo("Tower", "Start assigning vacant sectors...");
+
+    client.start_replan_listener([this](const std::vector<int>& sectorIDs) {
+        return cerebrum.replanSectors(sectorIDs);
+    });
+    logInfo("Tower", "Start listening for re-plan requests...");
+
     visualizationThread(std::ref(client), sectors);
 }
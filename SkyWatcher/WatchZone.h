@@ -12,10 +12,12 @@ class WatchZone {
 private:
     int width, height, timeScale;
     Position center = {static_cast<double>(width/2), static_cast<double>(height/2)};
+    Grid grid;
     std::vector<std::shared_ptr<Sector>> sectors;
     std::vector<Drone> drones;
     Cerebrum cerebrum;
     RedisCommunication redisCommunication;
+    std::shared_ptr<const RealClock> clock;     // Mission clock of the tower
     TowerClient client;
     std::vector<std::shared_ptr<Sector>> createSectors();
     sf::Vector2f scalePosition(double x, double y) const;
@@ -33,7 +35,7 @@ private:
     float cellWidth = static_cast<float>(windowWidth) / numCols;
     float cellHeight = static_cast<float>(windowHeight) / numRows;
 public:
-    WatchZone(int areaSize, int timeScale);
+    WatchZone(int areaSize, int timeScale, const TowerOptions& options);
 };
 
 
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "Utils/Assignment.h"
+#include "Tests/Check.h"
+
+namespace {
+    constexpr double forbidden = 1e12;
+
+    double total(const std::vector<double> &cost, const int cols, const std::vector<int> &assignment) {
+        double sum = 0;
+        for (int row = 0; row < static_cast<int>(assignment.size()); ++row)
+            if (assignment[row] != -1)
+                sum += cost[static_cast<std::size_t>(row) * cols + assignment[row]];
+        return sum;
+    }
+
+    // Best total over every matching of min(rows, cols) pairs avoiding forbidden ones, and its size
+    std::pair<double, int> bruteForce(const std::vector<double> &cost, const int rows, const int cols) {
+        std::vector<int> columns(std::max(rows, cols));
+        std::iota(columns.begin(), columns.end(), 0);
+        double best = forbidden;
+        int bestSize = 0;
+        // Permute over the larger side, the first min(rows, cols) entries form the matching
+        do {
+            double sum = 0;
+            int size = 0;
+            for (int k = 0; k < std::min(rows, cols); ++k) {
+                const int row = rows <= cols ? k : columns[k];
+                const int col = rows <= cols ? columns[k] : k;
+                const double c = cost[static_cast<std::size_t>(row) * cols + col];
+                if (c < forbidden) {
+                    sum += c;
+                    size++;
+                }
+            }
+            if (size > bestSize || (size == bestSize && sum < best)) {
+                best = sum;
+                bestSize = size;
+            }
+        } while (std::next_permutation(columns.begin(), columns.end()));
+        return {best, bestSize};
+    }
+
+    bool isMatching(const std::vector<int> &assignment, const int cols) {
+        std::vector<char> taken(cols, 0);
+        for (const int col : assignment) {
+            if (col == -1)
+                continue;
+            if (col < 0 || col >= cols || taken[col])
+                return false;
+            taken[col] = 1;
+        }
+        return true;
+    }
+}
+
+int main() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> costs(0, 1000);
+    std::bernoulli_distribution forbid(0.15);
+
+    for (int trial = 0; trial < 300; ++trial) {
+        const int rows = 1 + trial % 6;
+        const int cols = 1 + (trial / 6) % 6;
+        std::vector<double> cost(static_cast<std::size_t>(rows) * cols);
+        for (auto &c : cost)
+            c = trial % 3 == 0 && forbid(random) ? forbidden : std::round(costs(random));
+
+        const auto assignment = minCostAssignment(cost, rows, cols, forbidden);
+        CHECK(static_cast<int>(assignment.size()) == rows);
+        CHECK(isMatching(assignment, cols));
+        for (int row = 0; row < rows; ++row)
+            CHECK(assignment[row] == -1 || cost[static_cast<std::size_t>(row) * cols + assignment[row]] < forbidden);
+
+        // Without forbidden pairs the matching is complete and optimal. With them, the solver minimises the total
+        // where forbidden pairs count as forbidden, so it only has to match brute force when a complete matching exists
+        const auto [best, bestSize] = bruteForce(cost, rows, cols);
+        const int size = static_cast<int>(std::count_if(assignment.begin(), assignment.end(), [](const int c) { return c != -1; }));
+        if (bestSize == std::min(rows, cols)) {
+            CHECK(size == bestSize);
+            CHECK(std::abs(total(cost, cols, assignment) - best) < 1e-6);
+        }
+    }
+
+    // Empty matrices
+    CHECK(minCostAssignment({}, 0, 5).empty());
+    CHECK(minCostAssignment({}, 3, 0) == std::vector<int>(3, -1));
+
+    return check::result("AssignmentTest");
+}
@@ -0,0 +1,31 @@
+#ifndef SKYWATCHER_CHECK_H
+#define SKYWATCHER_CHECK_H
+
+#include <iostream>
+
+// Minimal check harness for the test executables: CHECK reports every failed condition with its location and the
+// test exits non-zero if any failed, which is all ctest needs
+namespace check {
+    inline int &failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char *expression, const char *file, const int line) {
+        std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+        failures()++;
+    }
+
+    inline int result(const char *name) {
+        if (failures() == 0)
+            std::cout << name << ": all checks passed" << std::endl;
+        else
+            std::cerr << name << ": " << failures() << " check(s) failed" << std::endl;
+        return failures() == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(...) ((__VA_ARGS__) ? (void)0 : check::fail(#__VA_ARGS__, __FILE__, __LINE__))
+
+
+#endif //SKYWATCHER_CHECK_H
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "SkyWatcher/LatticeSolver.h"
+#include "Tests/Check.h"
+
+namespace {
+    std::vector<Position> lattice(const int rows, const int cols, const double step) {
+        std::vector<Position> positions;
+        for (int row = 0; row < rows; ++row)
+            for (int col = 0; col < cols; ++col)
+                positions.push_back({100 + col * step, 50 + row * step});
+        return positions;
+    }
+
+    // Closed tour visiting every waypoint once, from start
+    bool isTour(const std::vector<int> &tour, const std::size_t count, const int start) {
+        if (tour.size() != count || tour.front() != start)
+            return false;
+        std::vector<int> sorted = tour;
+        std::sort(sorted.begin(), sorted.end());
+        for (std::size_t i = 0; i < count; ++i)
+            if (sorted[i] != static_cast<int>(i))
+                return false;
+        return true;
+    }
+
+    void checkLattice(const int rows, const int cols, const int start) {
+        const double step = CELL_SIZE;
+        auto positions = lattice(rows, cols, step);
+        // Waypoint order must not matter
+        std::reverse(positions.begin(), positions.end());
+        const LatticeSolver solver(positions);
+        CHECK(solver.isLattice());
+        CHECK(solver.getRows() == rows);
+        CHECK(solver.getCols() == cols);
+
+        const auto tour = solver.solve(start);
+        CHECK(isTour(tour, positions.size(), start));
+
+        // Optimal: one step per waypoint, plus a single diagonal when both sides are odd
+        const double n = static_cast<double>(positions.size());
+        const double optimal = rows % 2 == 0 || cols % 2 == 0 ? n * step : (n - 1 + std::sqrt(2.0)) * step;
+        CHECK(std::abs(LatticeSolver::tourLength(tour, positions) - optimal) < 1e-6);
+    }
+}
+
+int main() {
+    checkLattice(10, 10, 0);
+    checkLattice(10, 10, 57);
+    checkLattice(5, 5, 12);
+    checkLattice(4, 7, 3);
+    checkLattice(7, 4, 27);
+    checkLattice(2, 2, 1);
+
+    // Missing waypoint, uneven spacing: not a lattice, no tour
+    auto holed = lattice(4, 4, CELL_SIZE);
+    holed.pop_back();
+    CHECK(!LatticeSolver(holed).isLattice());
+    CHECK(LatticeSolver(holed).solve(0).empty());
+    auto uneven = lattice(3, 3, CELL_SIZE);
+    for (auto &position : uneven)
+        if (position.x > 100 + CELL_SIZE)
+            position.x += 7;
+    CHECK(!LatticeSolver(uneven).isLattice());
+
+    // Polish never lengthens a tour and keeps its start
+    const auto positions = lattice(6, 6, CELL_SIZE);
+    const LatticeSolver solver(positions);
+    std::vector<int> scrambled(positions.size());
+    for (int i = 0; i < static_cast<int>(scrambled.size()); ++i)
+        scrambled[i] = (i * 7) % static_cast<int>(scrambled.size());
+    const double before = LatticeSolver::tourLength(scrambled, positions);
+    solver.polish(scrambled);
+    CHECK(isTour(scrambled, positions.size(), 0));
+    CHECK(LatticeSolver::tourLength(scrambled, positions) <= before);
+
+    return check::result("LatticeSolverTest");
+}
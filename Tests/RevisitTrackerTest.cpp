@@ -0,0 +1,210 @@
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Monitor/RevisitTracker.h"
+#include "Monitor/StatusLog.h"
+#include "Tests/Check.h"
+
+using namespace std::chrono_literals;
+using TimePoint = RevisitTracker::TimePoint;
+
+namespace {
+    const TimePoint t0 = TimePoint(std::chrono::duration_cast<RevisitTracker::Duration>(1700000000s));
+
+    bool sameStats(const RevisitTracker &a, const RevisitTracker &b) {
+        if (a.getCellCount() != b.getCellCount())
+            return false;
+        for (int cell = 0; cell < a.getCellCount(); ++cell) {
+            const auto x = a.getStats(cell), y = b.getStats(cell);
+            if (x.visited != y.visited || x.lastVisit != y.lastVisit || x.maxGap != y.maxGap || x.violations != y.violations || x.histogram != y.histogram)
+                return false;
+        }
+        return true;
+    }
+
+    void checkVisits() {
+        RevisitTracker tracker(4, 30min);
+        CHECK(!tracker.isStarted());
+        tracker.start(t0);
+        CHECK(tracker.isStarted());
+
+        // A visit at the start time is the first visit of the cell, not a duplicate
+        CHECK(!tracker.visit(0, t0));
+        CHECK(tracker.getStats(0).visited);
+        CHECK(tracker.getStats(0).lastVisit == t0);
+        // A second visit at the same time, or an older one, is dropped
+        tracker.visit(0, t0);
+        tracker.visit(0, t0 - 1min);
+        CHECK(tracker.getStats(0).histogram == (std::array<uint32_t, RevisitTracker::histogramBins>{}));
+
+        // Revisits land in quarters of maxInterval, the last bin takes every gap of twice maxInterval or more
+        tracker.visit(0, t0 + 10min);
+        tracker.visit(0, t0 + 50min);
+        tracker.visit(0, t0 + 200min);
+        const auto stats = tracker.getStats(0);
+        CHECK(stats.histogram[1] == 1);
+        CHECK(stats.histogram[5] == 1);
+        CHECK(stats.histogram[7] == 1);
+        CHECK(stats.violations == 2);
+        CHECK(stats.maxGap == 150min);
+
+        // The first visit after the start is not a revisit, but its gap from the start counts
+        tracker.visit(1, t0 + 40min);
+        CHECK(tracker.getStats(1).visited);
+        CHECK(tracker.getStats(1).violations == 1);
+        CHECK(tracker.getStats(1).histogram == (std::array<uint32_t, RevisitTracker::histogramBins>{}));
+
+        // Closing counts the gaps still open, never visited cells included
+        tracker.close(t0 + 230min);
+        CHECK(tracker.getStats(0).violations == 3);
+        CHECK(!tracker.getStats(2).visited);
+        CHECK(tracker.getStats(2).maxGap == 230min);
+        CHECK(tracker.getStats(2).violations == 1);
+    }
+
+    void checkOverdue() {
+        RevisitTracker tracker(3, 30min);
+        tracker.start(t0);
+        tracker.visit(0, t0 + 5min);
+        std::vector<RevisitTracker::Gap> overdue;
+
+        tracker.collectOverdue(t0 + 29min, overdue);
+        CHECK(overdue.empty());
+        tracker.collectOverdue(t0 + 30min, overdue);
+        CHECK(overdue.size() == 2);     // Cells 1 and 2, never visited
+        tracker.collectOverdue(t0 + 36min, overdue);
+        CHECK(overdue.size() == 1 && overdue[0].cellIndex == 0 && overdue[0].lastVisit == t0 + 5min);
+        tracker.collectOverdue(t0 + 60min, overdue);
+        CHECK(overdue.empty());         // Once per gap
+
+        // The visit closing an overdue gap returns it, and the cell can become overdue again
+        const auto gap = tracker.visit(0, t0 + 70min);
+        CHECK(gap && gap->cellIndex == 0 && gap->lastVisit == t0 + 5min);
+        CHECK(!tracker.visit(0, t0 + 71min));
+        tracker.collectOverdue(t0 + 101min, overdue);
+        CHECK(overdue.size() == 1 && overdue[0].cellIndex == 0);
+    }
+
+    void checkCheckpoint() {
+        RevisitTracker tracker(5, 30min);
+        tracker.start(t0);
+        tracker.visit(0, t0);
+        tracker.visit(3, t0 + 12min);
+        tracker.visit(3, t0 + 70min);
+        std::vector<RevisitTracker::Gap> overdue;
+        tracker.collectOverdue(t0 + 90min, overdue);
+
+        const std::string checkpoint = tracker.serialize();
+        RevisitTracker restored(5, 30min);
+        CHECK(restored.restore(checkpoint));
+        CHECK(restored.isStarted());
+        CHECK(sameStats(tracker, restored));
+        CHECK(restored.serialize() == checkpoint);
+
+        // Overdue flags survive: cells already reported are not reported again, and their next visit closes the gap
+        restored.collectOverdue(t0 + 95min, overdue);
+        CHECK(overdue.empty());
+        CHECK(restored.visit(0, t0 + 100min).has_value());
+
+        // Another grid, a truncated or padded checkpoint is rejected and leaves the tracker unchanged
+        RevisitTracker other(6, 30min);
+        CHECK(!other.restore(checkpoint));
+        CHECK(!other.isStarted());
+        const std::string before = tracker.serialize();
+        CHECK(!tracker.restore(checkpoint.substr(0, checkpoint.size() - 1)));
+        CHECK(!tracker.restore(checkpoint + '\0'));
+        CHECK(tracker.serialize() == before);
+    }
+
+    // A checkpoint followed by its changes restores the tracker, the way the monitor stores it
+    void checkChanges() {
+        RevisitTracker tracker(6, 30min);
+        tracker.start(t0);
+        tracker.visit(1, t0 + 5min);
+        const std::string checkpoint = tracker.serialize();
+        tracker.clearChanges();
+        CHECK(tracker.getChangeCount() == 0);
+
+        // Visits and overdue reports are changes, a cell counts once however often it changed
+        std::vector<RevisitTracker::Gap> overdue;
+        tracker.visit(2, t0 + 10min);
+        tracker.visit(2, t0 + 20min);
+        tracker.collectOverdue(t0 + 31min, overdue);
+        CHECK(tracker.getChangeCount() == 5);       // 2, then 0, 3, 4 and 5 overdue (1 is not yet)
+        const std::string first = tracker.serializeChanges();
+        tracker.clearChanges();
+        tracker.visit(0, t0 + 40min);
+        const std::string second = tracker.serializeChanges();
+        CHECK(second.size() < first.size());
+
+        RevisitTracker restored(6, 30min);
+        CHECK(restored.restore(checkpoint));
+        CHECK(restored.applyChanges(first));
+        CHECK(restored.applyChanges(second));
+        CHECK(sameStats(tracker, restored));
+        CHECK(restored.getChangeCount() == 0);
+
+        // Truncated changes, or changes of a larger grid, are rejected and leave the tracker unchanged
+        RevisitTracker smaller(5, 30min);
+        smaller.start(t0);
+        const std::string before = smaller.serialize();
+        CHECK(!smaller.applyChanges(first));
+        CHECK(!restored.applyChanges(second.substr(0, second.size() - 1)));
+        CHECK(!restored.applyChanges(second + '\0'));
+        CHECK(smaller.serialize() == before);
+        CHECK(sameStats(tracker, restored));
+    }
+
+    // Short status_logs stream, replayed the way the monitor reads it: the tracker starts at the first valid entry
+    void checkFixtureStream() {
+        using Fields = std::vector<std::pair<std::string, std::string>>;
+        const Grid grid(60, 40);    // 3 x 2 cells
+        const auto cellEvent = [&](const int drone, const int x, const int y, const TimePoint time, const wire::Encoding encoding) {
+            return Fields{{"cell", wire::encodeCellEvent({drone, x, y, time}, encoding)}};
+        };
+        const std::vector<std::pair<std::string, Fields>> stream = {
+            {"1-0", cellEvent(1, 0, 0, t0, wire::Encoding::Binary)},            // Only visit of cell (0, 0)
+            {"2-0", cellEvent(1, 1, 0, t0 + 10min, wire::Encoding::Binary)},
+            {"3-0", cellEvent(2, 5, 0, t0 + 11min, wire::Encoding::Binary)},    // Outside the grid
+            {"4-0", {{"cell", "garbage"}}},
+            {"5-0", cellEvent(2, 1, 0, t0 + 50min, wire::Encoding::Json)},
+            {"6-0", cellEvent(2, 2, 1, t0 + 60min, wire::Encoding::Binary)},
+        };
+
+        RevisitTracker tracker(grid.getCellCount(), 30min);
+        TimePoint end = TimePoint::min();
+        int valid = 0;
+        for (const auto &[id, fields] : stream) {
+            const auto visit = read_cell_visit(fields, grid);
+            if (!visit)
+                continue;
+            valid++;
+            if (!tracker.isStarted())
+                tracker.start(visit->time);
+            tracker.visit(visit->cell_index, visit->time);
+            end = std::max(end, visit->time);
+        }
+        tracker.close(end);
+
+        CHECK(valid == 4);
+        CHECK(tracker.getStats(0).visited);                 // Visited once, at the very first entry
+        CHECK(tracker.getStats(0).lastVisit == t0);
+        CHECK(tracker.getStats(0).violations == 1);         // Then left alone for an hour
+        CHECK(tracker.getStats(1).visited);
+        CHECK(tracker.getStats(1).histogram[5] == 1);       // 40 minutes between its two visits
+        CHECK(tracker.getStats(5).visited);
+        CHECK(tracker.getStats(5).violations == 1);         // First visited an hour after the start
+        for (const int cell : {2, 3, 4})
+            CHECK(!tracker.getStats(cell).visited);
+    }
+}
+
+int main() {
+    checkVisits();
+    checkOverdue();
+    checkCheckpoint();
+    checkChanges();
+    checkFixtureStream();
+    return check::result("RevisitTrackerTest");
+}
@@ -0,0 +1,58 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "Utils/SenderPool.h"
+#include "Tests/Check.h"
+
+using namespace std::chrono_literals;
+
+int main() {
+    constexpr int keys = 16;
+    constexpr int jobsPerKey = 2000;
+
+    // The jobs of a key run in order and never concurrently, whatever the thread posting them
+    {
+        SenderPool pool(3);
+        std::vector<int> next(keys, 0);
+        std::vector<std::atomic<int>> running(keys);
+        std::atomic<int> outOfOrder{0}, overlaps{0}, done{0};
+        std::vector<std::thread> posters;
+        for (int p = 0; p < 4; p++) {
+            posters.emplace_back([&, p] {
+                for (int key = p; key < keys; key += 4)
+                    for (int i = 0; i < jobsPerKey; i++)
+                        pool.post(key, [&, key, i] {
+                            overlaps += running[key]++ != 0;
+                            outOfOrder += next[key] != i;
+                            next[key] = i + 1;
+                            running[key]--;
+                            done++;
+                        });
+            });
+        }
+        for (auto &poster : posters)
+            poster.join();
+        const auto end = std::chrono::steady_clock::now() + 10s;
+        while (done.load() < keys * jobsPerKey && std::chrono::steady_clock::now() < end)
+            std::this_thread::sleep_for(1ms);
+        CHECK(done.load() == keys * jobsPerKey);
+        CHECK(outOfOrder.load() == 0);
+        CHECK(overlaps.load() == 0);
+    }
+
+    // A failing job does not stop its lane
+    {
+        SenderPool pool(1);
+        std::atomic<bool> ran{false};
+        pool.post(0, [] { throw std::runtime_error("connection lost"); });
+        pool.post(0, [&] { ran = true; });
+        const auto end = std::chrono::steady_clock::now() + 5s;
+        while (!ran.load() && std::chrono::steady_clock::now() < end)
+            std::this_thread::sleep_for(1ms);
+        CHECK(ran.load());
+    }
+
+    return check::result("SenderPoolTest");
+}
@@ -0,0 +1,111 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "Utils/TimerWheel.h"
+#include "Tests/Check.h"
+
+using namespace std::chrono_literals;
+using Clock = TimerWheel::Clock;
+
+namespace {
+    // Wait until predicate holds, false on timeout
+    template <typename Predicate>
+    bool waitFor(Predicate predicate, const Clock::duration timeout = 5s) {
+        const auto end = Clock::now() + timeout;
+        while (!predicate()) {
+            if (Clock::now() > end)
+                return false;
+            std::this_thread::sleep_for(1ms);
+        }
+        return true;
+    }
+
+    // A one-shot timer fires once, not before its deadline
+    void checkDeadline(TimerWheel &wheel, const Clock::duration delay) {
+        std::atomic<int> runs{0};
+        std::atomic<int64_t> firedAt{0};
+        const auto deadline = Clock::now() + delay;
+        wheel.schedule(deadline, [&] {
+            firedAt = Clock::now().time_since_epoch().count();
+            runs++;
+        });
+        CHECK(waitFor([&] { return runs.load() == 1; }));
+        CHECK(Clock::time_point(Clock::duration(firedAt.load())) >= deadline);
+        std::this_thread::sleep_for(20ms);
+        CHECK(runs.load() == 1);
+    }
+}
+
+int main() {
+    // 10µs ticks: 256 ticks (level 1) is 2.56ms, 65536 ticks (level 2) is 655ms
+    TimerWheel wheel(2, 10us);
+
+    // First level, then timers that cascade down one and two levels
+    checkDeadline(wheel, 1ms);
+    checkDeadline(wheel, 30ms);
+    checkDeadline(wheel, 800ms);
+
+    // Timers due together, scheduled out of order, all fire
+    {
+        std::atomic<int> runs{0};
+        const auto now = Clock::now();
+        for (int i = 20; i > 0; i--)
+            wheel.schedule(now + i * 3ms, [&] { runs++; });
+        CHECK(waitFor([&] { return runs.load() == 20; }));
+    }
+
+    // Cancelled timers never fire, on any level; cancelling twice or after firing fails
+    {
+        std::atomic<int> runs{0};
+        const auto now = Clock::now();
+        const auto soon = wheel.schedule(now + 5ms, [&] { runs++; });
+        const auto later = wheel.schedule(now + 50ms, [&] { runs++; });
+        const auto coarse = wheel.schedule(now + 700ms, [&] { runs++; });
+        const auto kept = wheel.schedule(now + 60ms, [&] { runs += 100; });
+        CHECK(wheel.cancel(soon));
+        CHECK(wheel.cancel(later));
+        CHECK(wheel.cancel(coarse));
+        CHECK(!wheel.cancel(coarse));
+        std::this_thread::sleep_for(900ms);
+        CHECK(runs.load() == 100);
+        CHECK(!wheel.cancel(kept));
+    }
+
+    // Periodic timers run until they return false, or until cancelled
+    {
+        std::atomic<int> runs{0};
+        wheel.scheduleEvery(Clock::now(), 2ms, [&] { return ++runs < 5; });
+        CHECK(waitFor([&] { return runs.load() == 5; }));
+        std::this_thread::sleep_for(20ms);
+        CHECK(runs.load() == 5);
+
+        std::atomic<int> ticks{0};
+        const auto id = wheel.scheduleEvery(Clock::now(), 1ms, [&] {
+            ticks++;
+            return true;
+        });
+        CHECK(waitFor([&] { return ticks.load() >= 3; }));
+        CHECK(wheel.cancel(id));
+        std::this_thread::sleep_for(10ms);     // Lets a run in progress complete
+        const int stopped = ticks.load();
+        std::this_thread::sleep_for(20ms);
+        CHECK(ticks.load() == stopped);
+    }
+
+    // Runs of one periodic timer never overlap, even when a run outlasts the period
+    {
+        std::atomic<int> running{0}, overlaps{0}, runs{0};
+        const auto id = wheel.scheduleEvery(Clock::now(), 1ms, [&] {
+            overlaps += running++ != 0;
+            std::this_thread::sleep_for(3ms);
+            running--;
+            return ++runs < 10;
+        });
+        CHECK(waitFor([&] { return runs.load() == 10; }));
+        CHECK(overlaps.load() == 0);
+        wheel.cancel(id);
+    }
+
+    return check::result("TimerWheelTest");
+}
@@ -0,0 +1,130 @@
+#include <chrono>
+#include <string>
+#include "Utils/WireFormat.h"
+#include "Tests/Check.h"
+
+namespace {
+    constexpr wire::Encoding encodings[] = {wire::Encoding::Binary, wire::Encoding::Json};
+
+    // Positions on a quarter-metre grid, exact in f32
+    Sector::Waypoints waypoints(const double offset) {
+        Sector::Waypoints result{};
+        for (std::size_t i = 0; i < result.size(); ++i)
+            result[i] = {offset + 20.0 * static_cast<double>(i % 10), -offset + 20.25 * static_cast<double>(i / 10)};
+        return result;
+    }
+
+    bool samePath(const wire::PathRef &a, const wire::PathRef &b) {
+        return a.startingPoint == b.startingPoint && a.tourID == b.tourID && a.mirror == b.mirror && a.tsp == b.tsp;
+    }
+
+    void checkStatus(const wire::Encoding encoding) {
+        for (int state = DroneState::Ready; state <= DroneState::Offline; state++) {
+            const Status status{static_cast<DroneState::Enum>(state), {1234.5, -87.25}, 63.5, 4711, wire::fromNanoseconds(1700000000123456000)};
+            const auto decoded = wire::decodeStatus(wire::encodeStatus(status, encoding));
+            CHECK(decoded.has_value());
+            if (!decoded)
+                continue;
+            CHECK(decoded->state == status.state);
+            CHECK(decoded->position == status.position);
+            CHECK(decoded->batteryLevel == status.batteryLevel);
+            CHECK(decoded->droneID == status.droneID);
+            CHECK(decoded->timestamp == status.timestamp);
+        }
+    }
+
+    // Time in the last 8 bytes of a binary status or cell event
+    uint64_t sentTime(const std::string &message) {
+        uint64_t sent = 0;
+        for (std::size_t i = message.size(); i > message.size() - 8; i--)
+            sent = sent << 8 | static_cast<unsigned char>(message[i - 1]);
+        return sent;
+    }
+
+    // Times are nanoseconds since the epoch on the wire, whatever the tick of system_clock
+    void checkTimes() {
+        using namespace std::chrono;
+        const system_clock::time_point time(duration_cast<system_clock::duration>(seconds(1700000000) + microseconds(123456)));
+        const Status status{DroneState::Monitoring, {0, 0}, 50, 1, time};
+        const wire::CellEvent event{1, 2, 3, time};
+        CHECK(sentTime(wire::encodeStatus(status, wire::Encoding::Binary)) == 1700000000123456000ull);
+        CHECK(sentTime(wire::encodeCellEvent(event, wire::Encoding::Binary)) == 1700000000123456000ull);
+        for (const auto encoding : encodings) {
+            const auto decodedStatus = wire::decodeStatus(wire::encodeStatus(status, encoding));
+            CHECK(decodedStatus && decodedStatus->timestamp == time);
+            const auto decodedEvent = wire::decodeCellEvent(wire::encodeCellEvent(event, encoding));
+            CHECK(decodedEvent && decodedEvent->timestamp == time);
+        }
+    }
+
+    void checkCellEvent(const wire::Encoding encoding) {
+        const wire::CellEvent event{17, 320, 4, wire::fromNanoseconds(1700000000654321000)};
+        const auto decoded = wire::decodeCellEvent(wire::encodeCellEvent(event, encoding));
+        CHECK(decoded.has_value());
+        if (decoded) {
+            CHECK(decoded->droneID == event.droneID);
+            CHECK(decoded->cellX == event.cellX);
+            CHECK(decoded->cellY == event.cellY);
+            CHECK(decoded->timestamp == event.timestamp);
+        }
+    }
+
+    void checkAssignments(const wire::Encoding encoding) {
+        const wire::PathRef byReference{{410, 230}, 0x0123456789abcdefull, 3, std::nullopt};
+        const wire::PathRef inlined{{10, 30}, 0, 1, waypoints(10)};
+
+        for (const auto &path : {byReference, inlined}) {
+            const auto decodedPath = wire::decodePath(wire::encodePath(path, encoding));
+            CHECK(decodedPath && samePath(*decodedPath, path));
+
+            const auto command = wire::decodeCommand(wire::encodeCommand({path, 321}, encoding));
+            CHECK(command && command->timer == 321 && samePath(command->path, path));
+
+            const auto init = wire::decodeInit(wire::encodeInit({9, {2000, 2000}, wire::Assignment{path, 45}}, encoding));
+            CHECK(init && init->droneID == 9 && init->towerPosition == Position{2000, 2000});
+            CHECK(init && init->assignment && init->assignment->timer == 45 && samePath(init->assignment->path, path));
+        }
+
+        const auto idle = wire::decodeInit(wire::encodeInit({3, {0, 0}, std::nullopt}, encoding));
+        CHECK(idle && idle->droneID == 3 && !idle->assignment);
+    }
+}
+
+int main() {
+    for (const auto encoding : encodings) {
+        checkStatus(encoding);
+        checkCellEvent(encoding);
+        checkAssignments(encoding);
+    }
+    checkTimes();
+
+    // Tours are checked against their ID, and a path expands back to the mirrored, translated tour
+    const auto tour = waypoints(0);
+    const std::string stored = wire::encodeTour(tour);
+    const uint64_t id = wire::tourID(stored);
+    CHECK(wire::decodeTour(stored, id) == tour);
+    CHECK(!wire::decodeTour(stored, id + 1));
+    std::string corrupted = stored;
+    corrupted.back() ^= 1;
+    CHECK(!wire::decodeTour(corrupted, id));
+    CHECK(wire::mirrorTour(wire::mirrorTour(tour, 3), 3) == tour);
+    const auto expanded = wire::expandPath(tour, {{100, 200}, id, 1, std::nullopt});
+    CHECK(expanded[5] == (Position{100 - tour[5].x, 200 + tour[5].y}));
+    CHECK(wire::tourKey(0xabcull) == "tour:0000000000000abc");
+
+    // Truncated, mistyped and foreign messages are rejected
+    const std::string status = wire::encodeStatus({DroneState::Monitoring, {1, 2}, 50, 1, {}}, wire::Encoding::Binary);
+    CHECK(!wire::decodeStatus(status.substr(0, status.size() - 1)));
+    CHECK(!wire::decodeCellEvent(status));
+    CHECK(!wire::decodeCommand(status));
+    CHECK(!wire::decodeStatus("{\"drone_id\": 1}"));
+    CHECK(!wire::decodeStatus(""));
+    std::string wrongVersion = status;
+    wrongVersion[1] = static_cast<char>(wire::version + 1);
+    CHECK(!wire::decodeStatus(wrongVersion));
+    const std::string command = wire::encodeCommand({{{0, 0}, 1, 0, std::nullopt}, 10}, wire::Encoding::Binary);
+    CHECK(!wire::decodeCommand(command + '\0'));
+    CHECK(!wire::decodeCommand(command.substr(0, command.size() - 1)));
+
+    return check::result("WireFormatTest");
+}
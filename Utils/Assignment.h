@@ -0,0 +1,88 @@
+#ifndef SKYWATCHER_ASSIGNMENT_H
+#define SKYWATCHER_ASSIGNMENT_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// Minimum-cost bipartite matching (Hungarian algorithm with potentials, O(n² m) for an n x m matrix with n <= m).
+// cost holds rows x cols values row by row; pairs costing at least forbidden (finite, far above any real cost) are
+// never matched.
+// Every row is matched if rows <= cols, every column otherwise, minimising the total cost; returns the column of each
+// row, -1 for the rows left unmatched
+inline std::vector<int> minCostAssignment(const std::vector<double> &cost, const int rows, const int cols,
+                                          const double forbidden = 1e12) {
+    std::vector<int> assignment(rows, -1);
+    if (rows == 0 || cols == 0)
+        return assignment;
+
+    // The algorithm matches every row of a matrix with at most as many rows as columns: transpose if needed
+    const bool transposed = rows > cols;
+    const int n = transposed ? cols : rows;
+    const int m = transposed ? rows : cols;
+    const auto at = [&](const int i, const int j) {
+        const double c = transposed ? cost[static_cast<std::size_t>(j) * cols + i] : cost[static_cast<std::size_t>(i) * cols + j];
+        return std::min(c, forbidden);
+    };
+
+    // 1-based, column 0 is the virtual column the current row starts from
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> u(n + 1, 0), v(m + 1, 0), minSlack(m + 1);
+    std::vector<int> matchedRow(m + 1, 0), previous(m + 1, 0);
+    std::vector<char> used(m + 1);
+    for (int i = 1; i <= n; i++) {
+        // Grow a shortest augmenting path from row i
+        matchedRow[0] = i;
+        int column = 0;
+        std::fill(minSlack.begin(), minSlack.end(), infinity);
+        std::fill(used.begin(), used.end(), 0);
+        do {
+            used[column] = 1;
+            const int row = matchedRow[column];
+            double delta = infinity;
+            int next = 0;
+            for (int j = 1; j <= m; j++) {
+                if (used[j])
+                    continue;
+                const double slack = at(row - 1, j - 1) - u[row] - v[j];
+                if (slack < minSlack[j]) {
+                    minSlack[j] = slack;
+                    previous[j] = column;
+                }
+                if (minSlack[j] < delta) {
+                    delta = minSlack[j];
+                    next = j;
+                }
+            }
+            for (int j = 0; j <= m; j++) {
+                if (used[j]) {
+                    u[matchedRow[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minSlack[j] -= delta;
+                }
+            }
+            column = next;
+        } while (matchedRow[column] != 0);
+
+        // Flip the path
+        do {
+            const int before = previous[column];
+            matchedRow[column] = matchedRow[before];
+            column = before;
+        } while (column != 0);
+    }
+
+    for (int j = 1; j <= m; j++) {
+        if (matchedRow[j] == 0)
+            continue;
+        const int row = transposed ? j - 1 : matchedRow[j] - 1;
+        const int col = transposed ? matchedRow[j] - 1 : j - 1;
+        if (cost[static_cast<std::size_t>(row) * cols + col] < forbidden)
+            assignment[row] = col;
+    }
+    return assignment;
+}
+
+
+#endif //SKYWATCHER_ASSIGNMENT_H
@@ -0,0 +1,80 @@
+#ifndef SKYWATCHER_CLOCK_H
+#define SKYWATCHER_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Mission time of the simulation, in seconds since the clock was created. One mission second lasts 1 / timeScale
+// wall clock seconds in a real-time run
+class Clock {
+public:
+    explicit Clock(const int timeScale) : timeScale(timeScale), systemEpoch(std::chrono::system_clock::now()) {}
+    virtual ~Clock() = default;
+
+    [[nodiscard]] virtual double now() const = 0;
+
+    // Block until the mission time reaches time
+    virtual void sleepUntil(double time) = 0;
+
+    void sleepFor(const double seconds) { sleepUntil(now() + seconds); }
+
+    // Wall clock time a real-time run would show at the given mission time, used for timestamps
+    [[nodiscard]] std::chrono::system_clock::time_point wallTime(const double time) const {
+        return systemEpoch + std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(time / timeScale));
+    }
+
+    [[nodiscard]] int getTimeScale() const { return timeScale; }
+
+protected:
+    int timeScale;
+
+private:
+    std::chrono::system_clock::time_point systemEpoch;
+};
+
+// Follows the wall clock, sped up by the time scale
+class RealClock final : public Clock {
+public:
+    explicit RealClock(const int timeScale) : Clock(timeScale), epoch(std::chrono::steady_clock::now()) {}
+
+    [[nodiscard]] double now() const override {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count() * timeScale;
+    }
+
+    void sleepUntil(const double time) override { std::this_thread::sleep_until(deadline(time)); }
+
+    // Steady clock time point of a mission time, to wait on condition variables or schedule timers
+    [[nodiscard]] std::chrono::steady_clock::time_point deadline(const double time) const {
+        return epoch + duration(time);
+    }
+
+    // Wall clock length of a mission duration
+    [[nodiscard]] std::chrono::steady_clock::duration duration(const double seconds) const {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds / timeScale));
+    }
+
+private:
+    std::chrono::steady_clock::time_point epoch;
+};
+
+// Only moves when its owner sleeps: an event loop jumps straight to its next event, so a run goes as fast as the CPU
+// allows and always processes its events in the same order. Meant for a single thread
+class VirtualClock final : public Clock {
+public:
+    explicit VirtualClock(const int timeScale) : Clock(timeScale) {}
+
+    [[nodiscard]] double now() const override { return time; }
+
+    // Never goes back in time
+    void sleepUntil(const double until) override {
+        if (until > time)
+            time = until;
+    }
+
+private:
+    std::atomic<double> time{0};
+};
+
+
+#endif //SKYWATCHER_CLOCK_H
@@ -0,0 +1,38 @@
+#ifndef SKYWATCHER_COMMANDLINE_H
+#define SKYWATCHER_COMMANDLINE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Arguments of the executables: positional arguments in order, plus --name and --name=value flags anywhere on the line
+class CommandLine {
+private:
+    std::vector<std::string> positionalArgs;
+    std::unordered_map<std::string, std::string> flags;
+
+public:
+    CommandLine(const int argc, char* argv[]) {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+                const auto equals = arg.find('=');
+                flags[arg.substr(2, equals - 2)] = equals == std::string::npos ? "" : arg.substr(equals + 1);
+            } else {
+                positionalArgs.push_back(arg);
+            }
+        }
+    }
+
+    [[nodiscard]] const std::vector<std::string>& positional() const { return positionalArgs; }
+
+    [[nodiscard]] bool has(const std::string& flag) const { return flags.count(flag) != 0; }
+
+    [[nodiscard]] std::string value(const std::string& flag, const std::string& fallback) const {
+        const auto it = flags.find(flag);
+        return it == flags.end() || it->second.empty() ? fallback : it->second;
+    }
+};
+
+
+#endif //SKYWATCHER_COMMANDLINE_H
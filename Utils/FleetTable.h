@@ -0,0 +1,191 @@
+#ifndef SKYWATCHER_FLEETTABLE_H
+#define SKYWATCHER_FLEETTABLE_H
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <vector>
+#include "Structs.h"
+
+// Role of a drone in the tower's bookkeeping
+enum class DroneRole : uint8_t {
+    None,       // Unknown ID, or removed after it stopped responding
+    Waiting,    // Connected, waiting for a sector
+    Active      // Assigned to a sector
+};
+
+// Tower-side state of the fleet, indexed by drone ID. IDs are handed out sequentially by the tower, so each field is
+// a dense array and every decision (who to monitor, is everybody waiting) is a scan over contiguous memory.
+// Drones ready to take a sector are also kept sorted in an index updated with every status, so the next one to
+// dispatch is found in O(log n) however many spares are waiting.
+// Not thread safe: the tower guards it with drones_mutex
+class FleetTable {
+private:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    std::vector<DroneRole> roles;
+    std::vector<DroneState::Enum> states;       // From the last status
+    std::vector<Position> positions;            // From the last status
+    std::vector<double> batteryLevels;          // From the last status
+    std::vector<TimePoint> statusTimestamps;    // Drone clock of the last status, epoch before the first one
+    std::vector<int> sectorIDs;                 // Sector patrolled by the drone, -1 if none
+    std::vector<std::chrono::system_clock::time_point> initializationTimes;
+
+    std::size_t activeCount = 0;
+    std::size_t waitingStateCount = 0;          // Drones whose last status is Waiting
+
+    // Dispatch order of the ready drones: fullest battery (to the percent) first, then the one closest to the dispatch
+    // point, which takes the least time to reach its sector, then the longest waiting one
+    struct ReadyKey {
+        int battery;
+        double distance;
+        int droneID;
+
+        bool operator<(const ReadyKey &other) const {
+            if (battery != other.battery)
+                return battery > other.battery;
+            if (distance != other.distance)
+                return distance < other.distance;
+            return droneID < other.droneID;
+        }
+    };
+    Position dispatchPoint;
+    std::set<ReadyKey> ready;                   // Waiting drones whose last status is Ready
+
+    void setStateCount(const int droneID, const int delta) {
+        if (statusTimestamps[droneID] != TimePoint{} && states[droneID] == DroneState::Waiting)
+            waitingStateCount += delta;
+    }
+
+    [[nodiscard]] ReadyKey readyKey(const int droneID) const {
+        const Position &position = positions[droneID];
+        return {static_cast<int>(batteryLevels[droneID]),
+                std::hypot(position.x - dispatchPoint.x, position.y - dispatchPoint.y), droneID};
+    }
+
+    // Called around every change of a field the index depends on: remove the drone with its old key, then add it back
+    // with the new one if it is still ready
+    void unindex(const int droneID) {
+        if (isReady(droneID))
+            ready.erase(readyKey(droneID));
+    }
+
+    void index(const int droneID) {
+        if (isReady(droneID))
+            ready.insert(readyKey(droneID));
+    }
+
+public:
+    // Ready drones are ranked by their distance to dispatchPoint, where spare drones wait
+    explicit FleetTable(const Position dispatchPoint = {0, 0}) : dispatchPoint(dispatchPoint) {}
+
+    // Register a newly connected drone as waiting for a sector
+    void add(const int droneID, const std::chrono::system_clock::time_point now) {
+        if (droneID >= size()) {
+            const std::size_t count = droneID + 1;
+            roles.resize(count, DroneRole::None);
+            states.resize(count, DroneState::Offline);
+            positions.resize(count, Position{0, 0});
+            batteryLevels.resize(count, 0);
+            statusTimestamps.resize(count);
+            sectorIDs.resize(count, -1);
+            initializationTimes.resize(count);
+        }
+        setRole(droneID, DroneRole::Waiting);
+        initializationTimes[droneID] = now;
+    }
+
+    // Number of slots, one past the highest drone ID
+    [[nodiscard]] int size() const { return static_cast<int>(roles.size()); }
+
+    [[nodiscard]] bool contains(const int droneID) const { return droneID >= 0 && droneID < size(); }
+
+    [[nodiscard]] DroneRole getRole(const int droneID) const { return contains(droneID) ? roles[droneID] : DroneRole::None; }
+
+    [[nodiscard]] bool isMonitored(const int droneID) const { return getRole(droneID) != DroneRole::None; }
+
+    void setRole(const int droneID, const DroneRole role) {
+        unindex(droneID);
+        activeCount -= roles[droneID] == DroneRole::Active;
+        roles[droneID] = role;
+        activeCount += role == DroneRole::Active;
+        index(droneID);
+    }
+
+    [[nodiscard]] int getSectorID(const int droneID) const { return contains(droneID) ? sectorIDs[droneID] : -1; }
+
+    void setSectorID(const int droneID, const int sectorID) { sectorIDs[droneID] = sectorID; }
+
+    [[nodiscard]] std::chrono::system_clock::time_point getInitializationTime(const int droneID) const { return initializationTimes[droneID]; }
+
+    void updateStatus(const int droneID, const Status &status) {
+        unindex(droneID);
+        setStateCount(droneID, -1);
+        states[droneID] = status.state;
+        positions[droneID] = status.position;
+        batteryLevels[droneID] = status.batteryLevel;
+        statusTimestamps[droneID] = status.timestamp != TimePoint{} ? status.timestamp : TimePoint(TimePoint::duration(1));
+        setStateCount(droneID, 1);
+        index(droneID);
+    }
+
+    void clearStatus(const int droneID) {
+        unindex(droneID);
+        setStateCount(droneID, -1);
+        statusTimestamps[droneID] = {};
+        states[droneID] = DroneState::Offline;
+    }
+
+    [[nodiscard]] bool hasStatus(const int droneID) const { return contains(droneID) && statusTimestamps[droneID] != TimePoint{}; }
+
+    [[nodiscard]] DroneState::Enum getState(const int droneID) const { return states[droneID]; }
+
+    [[nodiscard]] Status getStatus(const int droneID) const {
+        Status status;
+        status.droneID = droneID;
+        status.state = states[droneID];
+        status.position = positions[droneID];
+        status.batteryLevel = batteryLevels[droneID];
+        status.timestamp = statusTimestamps[droneID];
+        return status;
+    }
+
+    [[nodiscard]] std::size_t getActiveCount() const { return activeCount; }
+
+    [[nodiscard]] std::size_t getWaitingStateCount() const { return waitingStateCount; }
+
+    // Monitored drones initialized at least gracePeriod ago, in ID order
+    void monitoredDrones(const std::chrono::system_clock::time_point now, const std::chrono::system_clock::duration gracePeriod,
+                         std::vector<int> &out) const {
+        out.clear();
+        for (int id = 0; id < size(); ++id)
+            if (roles[id] != DroneRole::None && now - initializationTimes[id] >= gracePeriod)
+                out.push_back(id);
+    }
+
+    // Waiting for a sector, and its last status is Ready
+    [[nodiscard]] bool isReady(const int droneID) const {
+        return getRole(droneID) == DroneRole::Waiting && statusTimestamps[droneID] != TimePoint{} && states[droneID] == DroneState::Ready;
+    }
+
+    // The first limit ready drones in dispatch order (see ReadyKey). They leave the index once their role changes
+    void readyDrones(const std::size_t limit, std::vector<int> &out) const {
+        out.clear();
+        for (auto it = ready.begin(); it != ready.end() && out.size() < limit; ++it)
+            out.push_back(it->droneID);
+    }
+
+    [[nodiscard]] std::size_t getReadyCount() const { return ready.size(); }
+
+    // Last status of every drone that reported one, in ID order
+    void statuses(std::vector<Status> &out) const {
+        out.clear();
+        for (int id = 0; id < size(); ++id)
+            if (statusTimestamps[id] != TimePoint{})
+                out.push_back(getStatus(id));
+    }
+};
+
+
+#endif //SKYWATCHER_FLEETTABLE_H
@@ -0,0 +1,84 @@
+#ifndef SKYWATCHER_FREESECTORINDEX_H
+#define SKYWATCHER_FREESECTORINDEX_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Sectors without a drone, as a lock-free bitset over sector IDs. Sectors are handed out lowest ID first, which is the
+// order the tower dispatches them in. Claiming a sector is a single compare-and-swap on the word holding its bit, so
+// any number of threads can claim and release sectors concurrently and each free sector goes to exactly one of them.
+// A claim only scans the words from the lowest one that may hold a free sector, which keeps bring-up flat in the
+// number of sectors
+class FreeSectorIndex {
+public:
+    // Every sector of [0, count) starts free
+    explicit FreeSectorIndex(const int count)
+        : count(count), wordCount((count + wordBits - 1) / wordBits), words(std::make_unique<std::atomic<uint64_t>[]>(wordCount)) {
+        for (int i = 0; i < wordCount; i++) {
+            const int bits = std::min(wordBits, count - i * wordBits);
+            words[i].store(bits == wordBits ? ~uint64_t{0} : (uint64_t{1} << bits) - 1);
+        }
+    }
+
+    // Take the free sector with the lowest ID, -1 if every sector has a drone
+    [[nodiscard]] int claim() {
+        for (int i = firstWord.load(); i < wordCount; i++) {
+            uint64_t word = words[i].load();
+            while (word != 0) {
+                const uint64_t bit = word & (~word + 1);
+                if (words[i].compare_exchange_weak(word, word & ~bit))
+                    return i * wordBits + lowestBit(bit);
+            }
+            // Word exhausted: later claims start after it. A sector released in the meantime moves the hint back,
+            // either in release or right here
+            int expected = i;
+            if (firstWord.compare_exchange_strong(expected, i + 1) && words[i].load() != 0)
+                lowerHint(i);
+        }
+        return -1;
+    }
+
+    // Take every free sector, in ID order
+    void claimAll(std::vector<int> &out) {
+        out.clear();
+        for (int i = firstWord.load(); i < wordCount; i++) {
+            for (uint64_t word = words[i].exchange(0); word != 0; word &= word - 1)
+                out.push_back(i * wordBits + lowestBit(word & (~word + 1)));
+        }
+    }
+
+    // Make a sector available again
+    void release(const int sectorID) {
+        if (sectorID < 0 || sectorID >= count)
+            return;
+        const int word = sectorID / wordBits;
+        words[word].fetch_or(uint64_t{1} << (sectorID % wordBits));
+        lowerHint(word);
+    }
+
+private:
+    static constexpr int wordBits = 64;
+
+    const int count;
+    const int wordCount;
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+    std::atomic<int> firstWord{0};     // No free sector before this word
+
+    void lowerHint(const int word) {
+        int hint = firstWord.load();
+        while (hint > word && !firstWord.compare_exchange_weak(hint, word)) {}
+    }
+
+    static int lowestBit(uint64_t bit) {
+        int index = 0;
+        while ((bit >>= 1) != 0)
+            index++;
+        return index;
+    }
+};
+
+
+#endif //SKYWATCHER_FREESECTORINDEX_H
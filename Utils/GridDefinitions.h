@@ -2,7 +2,10 @@
 #define SKYWATCHER_GRIDDEFINITIONS_H
 
 #include <vector>
+#include <atomic>
+#include <cmath>
 #include "Utils/utils.h"
+#include "Utils/SectorGeometry.h"
 
 class Cell {
 private:
@@ -22,54 +25,95 @@ public:
 };
 
 
-// A sector is a 10x10 sub-grid of cells
-class Sector {
+// Where a position falls on the grid
+struct GridLocation {
+    int cellX, cellY;   // Column and row of the cell
+    int cellIndex;      // cellY * cols + cellX, -1 outside the area
+    int sectorID;       // Sector containing the cell (numbered row by row like WatchZone::createSectors), -1 outside the area
+    int regionID;       // Region of that sector (0: top-left, 1: top-right, 2: bottom-left, 3: bottom-right), -1 outside the area
+};
+
+// Implicit grid of cellSize x cellSize cells covering the area, split in sectorSide x sectorSide sectors.
+// Cells are not stored: their bounds and centers are computed from the row and column indices,
+// and positions are resolved to cell, sector and region with a few arithmetic operations
+class Grid {
+private:
+    float width, height, cellSize;
+    int rows, cols;
+    int sectorSide, sectorCols;
+
+public:
+    Grid(const int width, const int height, const float cellSize = CELL_SIZE, const int sectorSide = SKYWATCHER_SECTOR_SIDE)
+        : width(width), height(height), cellSize(cellSize),
+          rows(static_cast<int>(std::ceil(height / cellSize))), cols(static_cast<int>(std::ceil(width / cellSize))),
+          sectorSide(sectorSide), sectorCols((cols + sectorSide - 1) / sectorSide) {}
+
+    [[nodiscard]] Cell getCell(const int row, const int col) const {
+        return {col * cellSize, (col + 1) * cellSize, row * cellSize, (row + 1) * cellSize};
+    }
+
+    [[nodiscard]] Position getCenter(const int row, const int col) const {
+        return {(col + 0.5) * cellSize, (row + 0.5) * cellSize};
+    }
+
+    // Region of the sector whose top-left cell is (cellY, cellX): the quadrant of the area it lies in
+    [[nodiscard]] int getRegionID(const int cellX, const int cellY) const {
+        const float half = height / cellSize / 2;
+        if (cellY < half)
+            return cellX < half ? 0 : 1;
+        return cellX < half ? 2 : 3;
+    }
+
+    [[nodiscard]] GridLocation locate(const Position &position) const {
+        const int cellX = static_cast<int>(std::floor(position.x / cellSize));
+        const int cellY = static_cast<int>(std::floor(position.y / cellSize));
+        if (cellX < 0 || cellX >= cols || cellY < 0 || cellY >= rows)
+            return {cellX, cellY, -1, -1, -1};
+        const int sectorX = cellX / sectorSide;
+        const int sectorY = cellY / sectorSide;
+        return {cellX, cellY, cellY * cols + cellX, sectorY * sectorCols + sectorX, getRegionID(sectorX * sectorSide, sectorY * sectorSide)};
+    }
+
+    // Batch version of locate, out must hold count locations
+    void locate(const Position *positions, const std::size_t count, GridLocation *out) const {
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = locate(positions[i]);
+    }
+
+    [[nodiscard]] int getRows() const { return rows; }
+    [[nodiscard]] int getCols() const { return cols; }
+    [[nodiscard]] int getCellCount() const { return rows * cols; }
+    [[nodiscard]] float getCellSize() const { return cellSize; }
+    [[nodiscard]] int getSectorSide() const { return sectorSide; }
+};
+
+
+// A sector is a Side x Side view on the grid, starting at cell (startY, startX)
+template <int Side>
+class BasicSector {
+public:
+    using Geometry = SectorGeometry<Side>;
+    using Waypoints = typename Geometry::Waypoints;
+
 private:
-    int sectorID, assignedDroneID, regionID;
+    int sectorID, regionID;
+    std::atomic<int> assignedDroneID;   // Assigned by the tower's handshake workers, read by the other tower threads
     float areaSize;
-    std::vector<std::vector<Cell*>> grid;
+    Grid grid;
+    int startX, startY;
     Position startingPoint{};
-    std::array<Position, 100> waypoints{};
-    std::array<Position, 100> path{};
+    Waypoints path{};
     double distance;
     int timer;
     int starting_index;
 
 public:
-    Sector(int sectorID, int startX, int startY, const std::vector<std::vector<std::shared_ptr<Cell>>>& allCells, const int size) : assignedDroneID(-1), areaSize(size) {
+    BasicSector(int sectorID, int startX, int startY, const Grid& grid, const int size) : assignedDroneID(-1), areaSize(size), grid(grid), startX(startX), startY(startY) {
         this->sectorID = sectorID;
-        this->grid.resize(10, std::vector<Cell*>(10));
-        for (int i = 0; i < 10; i++) {
-            for (int j = 0; j < 10; j++) {
-                this->grid[i][j] = allCells[startY + i][startX + j].get();
-                waypoints[i * 10 + j] = this->grid[i][j]->getCenter();
-            }
-        }
-        // Set the starting point based on the sector's position (starting point should be the center of the closest cell to the center of the area)
-        if(const float temp = (areaSize / 10) / 4; startY < temp && startX < temp){
-            // Top-left region
-            startingPoint = this->grid[9][9]->getCenter();
-            regionID = 0;
-            starting_index = 99;
-        }
-        else if(startY < temp){
-            // Top-right region
-            startingPoint = this->grid[9][0]->getCenter();
-            regionID = 1;
-            starting_index = 90;
-        }
-        else if(startX < temp){
-            // Bottom-left region
-            startingPoint = this->grid[0][9]->getCenter();
-            regionID = 2;
-            starting_index = 9;
-        }
-        else{
-            // Bottom-right region
-            startingPoint = this->grid[0][0]->getCenter();
-            regionID = 3;
-            starting_index = 0;
-        }
+        // Set the starting point based on the sector's region (starting point should be the center of the closest cell to the center of the area)
+        regionID = grid.getRegionID(startX, startY);
+        starting_index = Geometry::startingIndex[regionID];
+        startingPoint = grid.getCenter(startY + starting_index / Side, startX + starting_index % Side);
 
         // Calculate travelTime
         distance = utils::calculateDistance(Position{areaSize / 2,areaSize / 2}, startingPoint);
@@ -78,14 +122,14 @@ public:
         const int temp = 1800 - 2 * travelTime;
 
         // Calculate the time after which the tower should send a new drone to this sector
-        timer = temp - static_cast<int>(std::fmod(temp, 240));
+        timer = temp - static_cast<int>(std::fmod(temp, Geometry::cycleTime));
     }
 
     void assignDrone(int droneID) {
         this->assignedDroneID = droneID;
     }
 
-    [[nodiscard]] std::array<Position, 100> getTSP() const
+    [[nodiscard]] Waypoints getTSP() const
     {
         return path;
     }
@@ -98,7 +142,12 @@ public:
         return starting_index;
     }
 
-    [[nodiscard]] const std::array<Position, 100>& getWaypoints() const {
+    // Cell centers, row by row
+    [[nodiscard]] Waypoints getWaypoints() const {
+        Waypoints waypoints{};
+        for (int i = 0; i < Side; i++)
+            for (int j = 0; j < Side; j++)
+                waypoints[i * Side + j] = grid.getCenter(startY + i, startX + j);
         return waypoints;
     }
 
@@ -106,7 +155,7 @@ public:
         return regionID;
     }
 
-    void setTSP(const std::array<Position, 100>& path) {
+    void setTSP(const Waypoints& path) {
         Position offset = this->startingPoint;
         std::transform(path.begin(), path.end(), this->path.begin(),
                    [offset](const Position& pos) {
@@ -126,10 +175,12 @@ public:
         return this->startingPoint;
     }
 
-    // Optionally provide methods to access or manipulate cells within the sector
-    [[nodiscard]] const std::vector<std::vector<Cell*>>& getGrid() const {
-        return grid;
+    // Cell (i, j) of the sector
+    [[nodiscard]] Cell getCell(const int i, const int j) const {
+        return grid.getCell(startY + i, startX + j);
     }
 };
 
+using Sector = BasicSector<SKYWATCHER_SECTOR_SIDE>;
+
 #endif //SKYWATCHER_GRIDDEFINITIONS_H
@@ -11,8 +11,11 @@ static std::mutex logMutex;
 
 // Function to get the current time as a formatted string
 std::string getCurrentTime() {
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    return formatTime(std::chrono::system_clock::now());
+}
+
+std::string formatTime(const std::chrono::system_clock::time_point time) {
+    auto in_time_t = std::chrono::system_clock::to_time_t(time);
 
     std::ostringstream ss;
     tm buf;
@@ -25,4 +25,7 @@ void logVisit(const std::string& subject, const std::string& message, const std:
 // Utility function to get current time
 std::string getCurrentTime();
 
+// Format a time point like getCurrentTime
+std::string formatTime(std::chrono::system_clock::time_point time);
+
 #endif // LOGGER_H
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef SKYWATCHER_RANDOM_H
+#define SKYWATCHER_RANDOM_H
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+
+// Random numbers of the simulation models. Every generator is derived from one process-wide seed and a stream key
+// (the drone ID), so a drone started with the same seed (--seed) draws the same values whatever the thread it runs on
+// or the order drones are created in; the seed is taken from std::random_device otherwise
+class Random {
+public:
+    static void seed(const uint64_t value) { baseSeed = value; }
+
+    // Generator of a stream, always the same for a given seed and key
+    [[nodiscard]] static std::mt19937_64 generator(const uint64_t stream) {
+        std::seed_seq sequence{static_cast<uint32_t>(baseSeed), static_cast<uint32_t>(baseSeed >> 32),
+                               static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+        return std::mt19937_64(sequence);
+    }
+
+private:
+    inline static std::atomic<uint64_t> baseSeed{std::random_device{}()};
+};
+
+
+#endif //SKYWATCHER_RANDOM_H
@@ -8,10 +8,24 @@
 #include <iostream>
 #include <atomic>
 #include <thread>
+#include <algorithm>
+#include <iterator>
+#include <charconv>
+#include <string_view>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include "GridDefinitions.h"
+#include "WireFormat.h"
+#include "FleetTable.h"
+#include "FreeSectorIndex.h"
+#include "Assignment.h"
+#include "Clock.h"
+#include "TimerWheel.h"
+#include "SenderPool.h"
 #include "Utils/Logger.h"
 
 using namespace sw::redis;
@@ -19,13 +33,17 @@ using namespace sw::redis;
 // Core Redis communication class (establishes a connection to Redis)
 class RedisCommunication {
 public:
-    RedisCommunication(const std::string &host, const int port) {
+    // pool_size connections are shared by the threads using the instance
+    RedisCommunication(const std::string &host, const int port, const std::size_t pool_size = 1) {
         ConnectionOptions connection_options;
         connection_options.host = host;  // Redis host
         connection_options.port = port;  // Redis port
 
+        ConnectionPoolOptions pool_options;
+        pool_options.size = pool_size;
+
         // Create a connection to Redis
-        redis = std::make_shared<Redis>(connection_options);
+        redis = std::make_shared<Redis>(connection_options, pool_options);
     }
 
     std::shared_ptr<Redis> get_redis_instance() {
@@ -36,24 +54,133 @@ private:
     std::shared_ptr<Redis> redis;
 };
 
+// Messages handed from a subscriber thread to the threads consuming them (a drone thread, the handshake workers)
+class MessageQueue {
+public:
+    void push(const std::string &message) {
+        {
+            std::lock_guard lock(mutex);
+            messages.push_back(message);
+        }
+        condition.notify_one();
+    }
+
+    std::string pop() {
+        std::unique_lock lock(mutex);
+        condition.wait(lock, [this] { return !messages.empty(); });
+        std::string message = std::move(messages.front());
+        messages.pop_front();
+        return message;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::string> messages;
+};
+
+// New relative patrol path of a sector
+using PathUpdate = std::pair<std::shared_ptr<Sector>, Sector::Waypoints>;
+// Re-plans a set of sectors (by ID) and returns the paths that changed
+using PathPlanner = std::function<std::vector<PathUpdate>(const std::vector<int>&)>;
+
+// How the tower keeps track of drone statuses
+enum class MonitorMode {
+    Polling,        // Periodically read every drone's status key
+    EventDriven     // Consume pushed statuses and status key expirations
+};
+
+// Runtime options of the tower, set from the command line
+struct TowerOptions {
+    MonitorMode monitorMode = MonitorMode::Polling;
+    wire::Encoding encoding = wire::Encoding::Binary;   // Encoding of the init and command messages
+    bool inlinePaths = false;   // Embed every patrol path in the messages instead of referencing a stored tour
+    unsigned handshakeWorkers = 0;  // Threads initializing connecting drones, one per core if 0
+    double assignmentPeriod = 1.0;  // Mission seconds between two runs of the assignment engine
+};
+
+// Latency of the tower's periodic status sweep (one batched fetch of every monitored drone's status)
+struct SweepStats {
+    std::size_t sweeps = 0;     // Sweeps completed since start
+    std::size_t drones = 0;     // Drones fetched by the last sweep
+    double last_ms = 0;         // Duration of the last sweep
+    double mean_ms = 0;         // Moving average over the last reporting window
+    double max_ms = 0;          // Slowest sweep of the current reporting window
+};
+
+// Immutable view of the fleet, published by the monitoring thread and shared by any number of readers
+struct FleetSnapshot {
+    uint64_t version = 0;                               // Incremented on every publication
+    std::chrono::steady_clock::time_point time;         // When it was taken
+    std::vector<Status> drones;                         // Last status of every monitored drone, sorted by drone ID
+
+    // Last status of a drone, nullptr if it is not in the snapshot
+    [[nodiscard]] const Status *find(const int drone_id) const {
+        const auto it = std::lower_bound(drones.begin(), drones.end(), drone_id,
+                                         [](const Status &status, const int id) { return status.droneID < id; });
+        return it != drones.end() && it->droneID == drone_id ? &*it : nullptr;
+    }
+};
+
 // Tower Client (for controlling drones)
 class TowerClient {
 public:
-    explicit TowerClient(const std::shared_ptr<Redis> &redis, std::vector<std::shared_ptr<Sector>> &s, const int timeScale, const Position pos) : redis(redis), drone_id_counter(0), sectors(s), timeScale(timeScale), tower_position(pos){}
+    // The tower's periods are in mission seconds of clock. Its timers run on the shared TimerWheel, in real time
+    explicit TowerClient(const std::shared_ptr<Redis> &redis, std::vector<std::shared_ptr<Sector>> &s, const Grid &grid,
+                         std::shared_ptr<const RealClock> clock, const Position pos, const TowerOptions &options = {})
+                         : redis(redis), sectors(s), grid(grid), drone_id_counter(0), clock(std::move(clock)), tower_position(pos), options(options),
+                           free_sectors(static_cast<int>(s.size())), sector_paths(s.size()) {}
 
-    // Start a listener thread to handle new drone connections
+    // Start a listener thread to handle new drone connections, and the workers initializing them
     void start_listening_for_drones() {
+        {
+            std::lock_guard lock(sectors_mutex);
+            for (const auto &sector : sectors)
+                update_sector_path(*sector);
+        }
+
+        const unsigned workers = options.handshakeWorkers != 0 ? options.handshakeWorkers : std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < workers; i++) {
+            std::thread worker_thread([this]() {
+                while (true)
+                    this->initialize_drone(handshakes.pop());
+            });
+            worker_thread.detach();
+        }
+
         std::thread listener_thread([this]() {
             this->listen_for_drone_connections();
         });
         listener_thread.detach();
     }
 
-    void start_monitoring_drones() {
-        std::thread monitor_thread([this]() {
-            this->monitor_drones();
+    // Polling sweeps every drone's status key, event-driven mode reacts to pushed statuses and key expirations
+    void start_monitoring_drones(const MonitorMode mode = MonitorMode::Polling) {
+        const auto period = clock->duration(0.1);  // Adjust as needed
+        const auto first = clock->deadline(clock->now() + 0.1);
+        if (mode == MonitorMode::EventDriven) {
+            TimerWheel::shared().scheduleEvery(first, period, [this]() {
+                this->snapshot_publisher();
+                return true;
+            });
+            std::thread monitor_thread(&TowerClient::listen_for_status_events, this);
+            monitor_thread.detach();
+        }
+        else {
+            TimerWheel::shared().scheduleEvery(first, period, [this]() {
+                this->monitor_drones();
+                return true;
+            });
+        }
+    }
+
+    // Periodically match the vacant sectors with the ready drones, see assign_vacant_sectors
+    void start_assignment_engine() {
+        const auto period = clock->duration(options.assignmentPeriod);
+        TimerWheel::shared().scheduleEvery(clock->deadline(clock->now() + options.assignmentPeriod), period, [this]() {
+            this->assign_vacant_sectors();
+            return true;
         });
-        monitor_thread.detach();
     }
 
     void start_substitution_listener()
@@ -64,6 +191,36 @@ public:
         substitution_thread.detach();
     }
 
+    // Re-plan requests ({"sectors": [ids]} on tower:replan) are solved by planner and only changed paths are published
+    void start_replan_listener(const PathPlanner &planner)
+    {
+        std::thread replan_thread([this, planner]() {
+            this->listen_for_replan_requests(planner);
+        });
+        replan_thread.detach();
+    }
+
+    // Install new relative paths on their sectors and push them to the drones currently flying those sectors
+    void apply_path_updates(const std::vector<PathUpdate> &updates)
+    {
+        std::vector<std::pair<int, wire::PathRef>> to_publish;
+        {
+            std::lock_guard lock(sectors_mutex);
+            for (const auto &[sector, relativePath] : updates) {
+                sector->setTSP(relativePath);
+                // Installed before reading the assigned drone: a drone assigned concurrently gets the new path
+                // either from its init message or from here
+                const auto path = update_sector_path(*sector);
+                if (const int droneID = sector->getAssignedDroneID(); droneID != -1)
+                    to_publish.emplace_back(droneID, *path);
+            }
+        }
+
+        for (const auto &[droneID, path] : to_publish)
+            redis->publish("drone:" + std::to_string(droneID) + ":path", wire::encodePath(path, options.encoding));
+        logInfo("Tower", "Path updated for " + std::to_string(updates.size()) + " sectors, " + std::to_string(to_publish.size()) + " drones notified");
+    }
+
     // Optionally broadcast a command to all drones
     void broadcast_command(const std::string &command) const
     {
@@ -72,25 +229,64 @@ public:
         logInfo("Tower", "Broadcast command: " + std::string(command));
     }
 
-    std::unordered_map<int, nlohmann::json> get_drone_statuses() {
-        std::lock_guard lock(drones_mutex);
-        return drone_statuses; // Returns a copy of the map
+    // Latest fleet snapshot, never blocks the monitoring thread: readers keep the snapshot they got alive
+    // while a newer one replaces it
+    [[nodiscard]] std::shared_ptr<const FleetSnapshot> get_fleet_snapshot() const {
+        return std::atomic_load(&fleet_snapshot);
+    }
+
+    // Latency of the status sweeps run by monitor_drones
+    SweepStats get_sweep_stats() {
+        std::lock_guard lock(sweep_stats_mutex);
+        return sweep_stats;
+    }
+
+    // Cell, sector and region under the last reported position of a drone (all -1 if unknown or outside the area)
+    [[nodiscard]] GridLocation locate_drone(const int drone_id) const {
+        const auto snapshot = get_fleet_snapshot();
+        const Status *status = snapshot->find(drone_id);
+        if (status == nullptr)
+            return {-1, -1, -1, -1, -1};
+        return grid.locate(status->position);
     }
 
 private:
     std::shared_ptr<Redis> redis;
     std::vector<std::shared_ptr<Sector>> sectors;
-    std::unordered_map<int, std::shared_ptr<Sector>> drone_to_sector_map;
+    const Grid &grid;
     std::mutex sectors_mutex;
     std::atomic<int> drone_id_counter;
-    int timeScale;
+    std::shared_ptr<const RealClock> clock;
 
     Position tower_position;
+    TowerOptions options;
+    std::unordered_set<uint64_t> stored_tours;  // Tours already written to Redis, guarded by sectors_mutex
+    FreeSectorIndex free_sectors;   // Sectors without a drone, claimed by the handshake workers
+    // Patrol path of each sector, by sector ID. Replaced with std::atomic_store under sectors_mutex, read with
+    // std::atomic_load without it
+    std::vector<std::shared_ptr<const wire::PathRef>> sector_paths;
+    MessageQueue handshakes;    // Handshake messages waiting for a worker
     std::mutex drones_mutex;
-    std::unordered_set<int> active_drones;  // Track active drones
-    std::unordered_set<int> waiting_drones;  // Track drones waiting for a sector
-    std::unordered_map<int, nlohmann::json> drone_statuses;  // Store drone statuses
-    std::unordered_map<int, std::chrono::system_clock::time_point> drone_initialization_time;
+    FleetTable fleet{tower_position};  // Roles, sectors and last statuses of the drones, guarded by drones_mutex
+
+    // Published with std::atomic_store, read with std::atomic_load
+    std::shared_ptr<const FleetSnapshot> fleet_snapshot = std::make_shared<const FleetSnapshot>();
+    std::atomic<bool> fleet_changed{false};     // Statuses changed since the last snapshot (event-driven mode)
+
+    // Assignment engine
+    static constexpr double drone_speed = 30 / 3.6;         // m/s, as assumed by the sector timers
+    static constexpr double flight_endurance = 1800;        // Mission seconds on a full battery, as assumed by the sector timers
+    static constexpr double missing_charge_cost = flight_endurance / 100;   // Per missing percent of battery
+    static constexpr double forbidden_cost = 1e12;
+    static constexpr std::size_t candidate_slack = 64;      // Ready drones considered beyond one per vacant sector
+    std::mutex assignment_mutex;                // One run of the engine at a time
+    std::atomic<bool> assignment_requested{false};
+    std::mutex snapshot_publish_mutex;
+
+    static constexpr std::size_t status_batch_size = 512;   // Keys per MGET, keeps each command short for the server
+    static constexpr std::size_t sweep_report_interval = 100;
+    std::mutex sweep_stats_mutex;
+    SweepStats sweep_stats;
 
 
     // Listen for new drone connections on the handshake channel
@@ -98,13 +294,11 @@ private:
         auto subscriber = redis->subscriber();
         subscriber.subscribe("drone:handshake");
 
-        // Handle incoming handshake messages from drones
+        // Handshakes are processed by the workers, so a burst of connecting drones does not hold up the subscriber
         subscriber.on_message([this](const std::string&, const std::string& message) {
-            this->initialize_drone(message);
+            handshakes.push(message);
         });
 
-        // Could be improved with threading to handle multiple connections concurrently
-
         // Continuously consume handshake messages
         try {
             while (true) {
@@ -137,162 +331,445 @@ private:
         }
     }
 
+    void listen_for_replan_requests(const PathPlanner &planner)
+    {
+        auto subscriber = redis->subscriber();
+        subscriber.subscribe("tower:replan");
+
+        subscriber.on_message([this, &planner](const std::string&, const std::string& message)
+        {
+            // Anyone can publish here: a malformed request is logged and dropped, it must not end the thread
+            nlohmann::json ids;
+            try {
+                ids = nlohmann::json::parse(message).at("sectors");
+            } catch (const nlohmann::json::exception &err) {
+                logWarning("Tower", "Ignoring re-plan request " + message + ": " + err.what());
+                return;
+            }
+            const auto valid = [this](const nlohmann::json &id) {
+                return id.is_number_integer() && id.get<long long>() >= 0 && id.get<long long>() < static_cast<long long>(sectors.size());
+            };
+            if (!ids.is_array() || !std::all_of(ids.begin(), ids.end(), valid)) {
+                logWarning("Tower", "Ignoring re-plan request " + message + ": sectors must be an array of sector IDs");
+                return;
+            }
+            const auto sector_ids = ids.get<std::vector<int>>();
+            logInfo("Tower", "Re-plan requested for sectors " + nlohmann::json(sector_ids).dump());
+            apply_path_updates(planner(sector_ids));
+        });
+
+        try {
+            while (true) {
+                subscriber.consume();
+            }
+        } catch (const Error &err) {
+            std::cerr << "Error consuming re-plan messages: " << err.what() << std::endl;
+            logError("Tower", "Error while consuming re-plan messages " + std::string(err.what()));
+        }
+    }
+
+    // The drone leaves its sector when its replacement arrives: the sector is vacant from now on and the assignment
+    // engine runs right away to send the best ready drone
     void substituteDrone(const int droneID)
     {
         std::cout << "Substitution message received: " << droneID << std::endl;
         logInfo("Tower", "Substitution message received from drone " + std::to_string(droneID));
-        std::lock_guard lock(sectors_mutex);
-        std::shared_ptr<Sector> sector = drone_to_sector_map[droneID];
+        int sectorID;
+        {
+            std::lock_guard lock(drones_mutex);
+            sectorID = fleet.getSectorID(droneID);
+            if (sectorID == -1) {
+                logWarning("Tower", "Drone " + std::to_string(droneID) + " asked for a substitution without a sector");
+                return;
+            }
+            fleet.setRole(droneID, DroneRole::Waiting);
+            fleet.setSectorID(droneID, -1);
+            sectors[sectorID]->assignDrone(-1);
+        }
+        free_sectors.release(sectorID);
+        request_assignment();
+    }
 
+    // Run the assignment engine as soon as possible, once however many times it is requested before it starts
+    void request_assignment() {
+        if (!assignment_requested.exchange(true))
+            TimerWheel::shared().schedule(std::chrono::steady_clock::now(), [this]() { this->assign_vacant_sectors(); });
+    }
+
+    // Cost in mission seconds of sending a ready drone to a vacant sector: its transit time to the sector's starting
+    // point, plus the flight time its missing charge would have given, so full drones go first. Forbidden if the
+    // battery cannot cover the transit, the patrol until the sector's timer and the flight back to the tower
+    [[nodiscard]] double assignment_cost(const Status &drone, const Sector &sector) const {
+        const Position start = sector.getStartingPoint();
+        const double transit = std::hypot(start.x - drone.position.x, start.y - drone.position.y) / drone_speed;
+        const double back = std::hypot(tower_position.x - start.x, tower_position.y - start.y) / drone_speed;
+        if (transit + sector.getTimer() + back > drone.batteryLevel / 100 * flight_endurance)
+            return forbidden_cost;
+        return transit + (100 - drone.batteryLevel) * missing_charge_cost;
+    }
+
+    // Match every vacant sector with a ready drone at the least total cost (see assignment_cost), by solving the
+    // assignment problem over the vacant sectors and the best ready drones. Only the fleet index's top candidates are
+    // considered, so a run stays small however many sectors and spare drones there are. The vacant sectors are taken
+    // out of free_sectors for the run, and those left without a drone are put back
+    void assign_vacant_sectors() {
+        std::lock_guard run_lock(assignment_mutex);
+        assignment_requested = false;
         {
             std::lock_guard lock(drones_mutex);
-            active_drones.erase(droneID);
-            drone_to_sector_map.erase(droneID);
-            waiting_drones.insert(droneID);
+            if (fleet.getReadyCount() == 0)
+                return;
         }
+        std::vector<int> vacant;
+        free_sectors.claimAll(vacant);
+        if (vacant.empty())
+            return;
 
-        for(const auto newDroneID : waiting_drones)
+        std::vector<Status> candidates;
         {
-            if(auto status = drone_statuses[newDroneID]; status["state"] == "Ready")
-            {
-                sector->assignDrone(newDroneID);
-                drone_to_sector_map[newDroneID] = sector;
-                {
-                    std::lock_guard lock(drones_mutex);
-                    waiting_drones.erase(newDroneID);
-                    active_drones.insert(newDroneID);
-                }
+            std::lock_guard lock(drones_mutex);
+            std::vector<int> ids;
+            fleet.readyDrones(vacant.size() + candidate_slack, ids);
+            candidates.reserve(ids.size());
+            for (const int id : ids)
+                candidates.push_back(fleet.getStatus(id));
+        }
 
-                const std::string channel = "drone:" + std::to_string(newDroneID) + ":commands";
-                const nlohmann::json msg = {{"starting_point", sector->getStartingPoint()}, {"timer", sector->getTimer()}, {"tsp", sector->getTSP()}};
-                redis->publish(channel, msg.dump());
-                std::cout << "Drone " << droneID << " substituted with " << newDroneID <<std::endl;
-                logInfo("Tower", "Drone " + std::to_string(droneID) + " substituted with drone " + std::to_string(newDroneID));
-                break;
+        const int rows = static_cast<int>(vacant.size());
+        const int cols = static_cast<int>(candidates.size());
+        std::vector<double> cost(static_cast<std::size_t>(rows) * cols);
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < cols; j++)
+                cost[static_cast<std::size_t>(i) * cols + j] = assignment_cost(candidates[j], *sectors[vacant[i]]);
+        const std::vector<int> match = minCostAssignment(cost, rows, cols, forbidden_cost);
+
+        // Drones that changed since the candidates were read (new status, handed a sector by a handshake...) are skipped
+        std::vector<std::pair<int, int>> assigned;     // Drone, sector
+        {
+            std::lock_guard lock(drones_mutex);
+            for (int i = 0; i < rows; i++) {
+                if (match[i] == -1)
+                    continue;
+                const int droneID = candidates[match[i]].droneID;
+                if (!fleet.isReady(droneID))
+                    continue;
+                fleet.setRole(droneID, DroneRole::Active);
+                fleet.setSectorID(droneID, vacant[i]);
+                sectors[vacant[i]]->assignDrone(droneID);
+                assigned.emplace_back(droneID, vacant[i]);
             }
         }
+        for (const int sectorID : vacant)
+            if (sectors[sectorID]->getAssignedDroneID() == -1)
+                free_sectors.release(sectorID);
+
+        for (const auto &[droneID, sectorID] : assigned) {
+            const auto path = std::atomic_load(&sector_paths[sectorID]);
+            redis->publish("drone:" + std::to_string(droneID) + ":commands",
+                           wire::encodeCommand({*path, sectors[sectorID]->getTimer()}, options.encoding));
+            std::cout << "Drone " << droneID << " sent to sector " << sectorID << std::endl;
+            logInfo("Tower", "Drone " + std::to_string(droneID) + " sent to sector " + std::to_string(sectorID));
+        }
+        if (assigned.size() < vacant.size())
+            logInfo("Tower", std::to_string(vacant.size() - assigned.size()) + " sectors still vacant, " + std::to_string(cols) + " ready drones considered");
+    }
+
+    // Reference to the patrol path of a sector, storing its tour in Redis the first time it is used.
+    // sectors_mutex must be held
+    wire::PathRef path_ref(const Sector &sector) {
+        wire::PathRef path{sector.getStartingPoint(), 0, static_cast<uint8_t>(sector.getRegionID()), std::nullopt};
+        if (options.inlinePaths) {
+            path.tsp = sector.getTSP();
+            return path;
+        }
+
+        // Back to offsets in the orientation of region 0, shared by every sector flying the same tour
+        Sector::Waypoints offsets = sector.getTSP();
+        for (auto &offset : offsets)
+            offset = offset - path.startingPoint;
+        const std::string tour = wire::encodeTour(wire::mirrorTour(offsets, path.mirror));
+        path.tourID = wire::tourID(tour);
+        if (stored_tours.count(path.tourID) == 0) {
+            redis->set(wire::tourKey(path.tourID), tour);
+            stored_tours.insert(path.tourID);
+            logInfo("Tower", "Stored tour " + wire::tourKey(path.tourID));
+        }
+        return path;
+    }
+
+    // Recompute the path handed to the drones of a sector after its tour changed. sectors_mutex must be held
+    std::shared_ptr<const wire::PathRef> update_sector_path(const Sector &sector) {
+        auto path = std::make_shared<const wire::PathRef>(path_ref(sector));
+        std::atomic_store(&sector_paths[sector.getSectorID()], path);
+        return path;
     }
 
+    // One polling sweep, run every 0.1 mission seconds
     void monitor_drones() {
-        while (true) {
-            std::vector<int> drones_to_check;
-            {
-                std::lock_guard lock(drones_mutex);
-                drones_to_check.assign(active_drones.begin(), active_drones.end());
-                drones_to_check.insert(drones_to_check.end(), waiting_drones.begin(), waiting_drones.end());
+        if (const std::size_t counter = sweep_statuses(); counter && counter == active_count())
+        {
+            broadcast_command("START");
+        }
+    }
+
+    std::size_t active_count() {
+        std::lock_guard lock(drones_mutex);
+        return fleet.getActiveCount();
+    }
+
+    // Fetch the status of every monitored drone once, returns how many of them are waiting to start
+    std::size_t sweep_statuses() {
+        const auto sweep_start = std::chrono::steady_clock::now();
+        // Skip drones still within the grace period after their initialization
+        std::vector<int> drones_to_check;
+        {
+            std::lock_guard lock(drones_mutex);
+            fleet.monitoredDrones(std::chrono::system_clock::now(), std::chrono::seconds(5), drones_to_check);
+        }
+
+        std::vector<std::string> status_keys;
+        status_keys.reserve(drones_to_check.size());
+        for (const int drone_id : drones_to_check)
+            status_keys.push_back("drone:" + std::to_string(drone_id) + ":status");
+
+        // Fetch all statuses with a few MGET round trips instead of one GET per drone
+        std::vector<OptionalString> replies;
+        replies.reserve(status_keys.size());
+        for (std::size_t first = 0; first < status_keys.size(); first += status_batch_size) {
+            const std::size_t last = std::min(first + status_batch_size, status_keys.size());
+            try {
+                redis->mget(status_keys.begin() + first, status_keys.begin() + last, std::back_inserter(replies));
+            } catch (const Error &err) {
+                std::cerr << "Error fetching drone statuses: " << err.what() << std::endl;
+                logError("Tower", "Error fetching drone statuses: " + std::string(err.what()));
+                record_sweep(std::chrono::steady_clock::now() - sweep_start, drones_to_check.size());
+                return 0;
             }
+        }
 
-            int counter = 0;
-            for (int drone_id : drones_to_check) {
-                // Check if the drone is within the grace period
-                if (auto init_time_it = drone_initialization_time.find(drone_id); init_time_it != drone_initialization_time.end()) {
-                    auto now = std::chrono::system_clock::now();
-                    if (auto duration_since_init = std::chrono::duration_cast<std::chrono::seconds>(now - init_time_it->second); duration_since_init.count() < 5) { // Grace period in seconds
-                        // Skip checking this drone until grace period is over
-                        continue;
-                    }
-                }
+        // Parse outside the lock, then store the whole sweep with a single lock acquisition
+        std::size_t counter = 0;
+        std::vector<std::pair<int, Status>> fetched;
+        std::vector<int> unresponsive;
+        for (std::size_t i = 0; i < drones_to_check.size(); ++i) {
+            if (!replies[i]) {
+                // Drone may be unresponsive
+                unresponsive.push_back(drones_to_check[i]);
+                continue;
+            }
+            if (const auto status = wire::decodeStatus(*replies[i])) {
+                if (status->state == DroneState::Waiting)
+                    counter++;
+                fetched.emplace_back(drones_to_check[i], *status);
+            } else {
+                logError("Tower", "Invalid status for drone " + std::to_string(drones_to_check[i]));
+            }
+        }
+        {
+            std::lock_guard lock(drones_mutex);
+            for (auto &[drone_id, status] : fetched)
+                store_status(drone_id, status);
+        }
+        for (const int drone_id : unresponsive)
+            handle_unresponsive_drone(drone_id);
+        publish_fleet_snapshot();
+
+        record_sweep(std::chrono::steady_clock::now() - sweep_start, drones_to_check.size());
+        return counter;
+    }
+
+    // Copy the statuses under the lock (already in ID order) and publish them outside it
+    void publish_fleet_snapshot() {
+        std::lock_guard publish_lock(snapshot_publish_mutex);  // Only orders the writers, readers never take it
+        auto snapshot = std::make_shared<FleetSnapshot>();
+        {
+            std::lock_guard lock(drones_mutex);
+            fleet.statuses(snapshot->drones);
+            fleet_changed = false;
+        }
+        snapshot->version = std::atomic_load(&fleet_snapshot)->version + 1;
+        snapshot->time = std::chrono::steady_clock::now();
+        std::atomic_store(&fleet_snapshot, std::shared_ptr<const FleetSnapshot>(std::move(snapshot)));
+    }
 
-                std::string status_key = "drone:" + std::to_string(drone_id) + ":status";
-
-                try {
-                    if (auto status_opt = redis->get(status_key)) {
-                        // Drone is alive; process status if needed
-                        {
-                            const nlohmann::json status = nlohmann::json::parse(*status_opt);
-                            if(status["state"] == "Waiting")
-                                counter++;
-                            std::lock_guard lock(drones_mutex);
-                            drone_statuses[drone_id] = status;
-                        }
-                    } else {
-                        // Drone may be unresponsive
-                        handle_unresponsive_drone(drone_id);
-                    }
-                } catch (const Error &err) {
-                    std::cerr << "Error fetching status for drone " << drone_id << ": " << err.what() << std::endl;
-                    logError("Tower", "Error fetching status for drone " + std::to_string(drone_id) + ": " + std::string(err.what()));
+    // In event-driven mode statuses change one at a time: batch them into one snapshot per monitoring period
+    void snapshot_publisher() {
+        if (fleet_changed)
+            publish_fleet_snapshot();
+    }
+
+    // Event-driven monitoring: statuses pushed on drone:status update the fleet as they arrive, and the expiration of a
+    // drone:<id>:status key (its TTL ran out without a refresh) marks that drone unresponsive straight away.
+    // Pub/sub does not replay missed messages, so the state is resynchronised with one sweep on every (re)subscription
+    void listen_for_status_events() {
+        enable_expiry_notifications();
+        while (true) {
+            auto subscriber = redis->subscriber();
+            subscriber.on_message([this](const std::string&, const std::string& message) {
+                on_status_event(message);
+            });
+            subscriber.on_pmessage([this](const std::string&, const std::string&, const std::string& key) {
+                on_status_expired(key);
+            });
+            subscriber.subscribe("drone:status");
+            subscriber.psubscribe("__keyevent@*__:expired");
+
+            try {
+                sweep_statuses();
+                while (true) {
+                    subscriber.consume();
                 }
+            } catch (const Error &err) {
+                std::cerr << "Error consuming status events: " << err.what() << std::endl;
+                logError("Tower", "Error while consuming status events, resubscribing: " + std::string(err.what()));
             }
-            if(counter && counter == active_drones.size())
-            {
-                broadcast_command("START");
-            }
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
 
-            std::this_thread::sleep_for(std::chrono::duration<float>(0.1 / timeScale)); // Adjust as needed
+    // Expired events are off by default on the server, turn them on without dropping other enabled classes
+    void enable_expiry_notifications() const {
+        try {
+            const auto current = redis->command<std::vector<std::string>>("CONFIG", "GET", "notify-keyspace-events");
+            std::string flags = current.size() == 2 ? current[1] : "";
+            if (flags.find('E') == std::string::npos && flags.find('A') == std::string::npos) flags += 'E';
+            if (flags.find('x') == std::string::npos && flags.find('A') == std::string::npos) flags += 'x';
+            redis->command("CONFIG", "SET", "notify-keyspace-events", flags);
+        } catch (const Error &err) {
+            logWarning("Tower", "Unable to enable keyspace notifications (notify-keyspace-events must include Ex): " + std::string(err.what()));
         }
     }
 
-    void handle_unresponsive_drone(const int drone_id) {
-        std::cout << "Drone " << drone_id << " is not responding. Taking action!" << std::endl;
-        logWarning("Tower", "Drone " + std::to_string(drone_id) + " is not responding. Taking action!");
+    void on_status_event(const std::string &message) {
+        const auto status = wire::decodeStatus(message);
+        if (!status) {
+            logError("Tower", "Invalid status event");
+            return;
+        }
+        const int drone_id = status->droneID;
 
+        bool start = false;
         {
-            std::lock_guard lock(sectors_mutex);
-            // Remove the drone from its sector
-            if (const auto it = drone_to_sector_map.find(drone_id); it != drone_to_sector_map.end()) {
-                it->second->assignDrone(-1);
-                drone_to_sector_map.erase(it);
-            }
+            std::lock_guard lock(drones_mutex);
+            // Only drones handed an ID by this tower are tracked
+            if (!fleet.isMonitored(drone_id))
+                return;
+            store_status(drone_id, *status);
+            start = fleet.getWaitingStateCount() && fleet.getWaitingStateCount() == fleet.getActiveCount();
         }
+        if (start)
+            broadcast_command("START");
+    }
+
+    void on_status_expired(const std::string &key) {
+        // Key is drone:<id>:status
+        constexpr std::string_view prefix = "drone:", suffix = ":status";
+        if (key.size() <= prefix.size() + suffix.size() || key.compare(0, prefix.size(), prefix) != 0
+            || key.compare(key.size() - suffix.size(), suffix.size(), suffix) != 0)
+            return;
+        int drone_id;
+        const char *first = key.data() + prefix.size(), *last = key.data() + key.size() - suffix.size();
+        if (const auto [end, ec] = std::from_chars(first, last, drone_id); ec != std::errc() || end != last)
+            return;
 
         {
             std::lock_guard lock(drones_mutex);
-            // Remove the drone from active drones
-            active_drones.erase(drone_id);
-            // Remove its status
-            drone_statuses.erase(drone_id);
+            if (!fleet.isMonitored(drone_id))
+                return;
         }
-        // Additional actions can be taken, such as alerting operators or reassigning tasks
+        handle_unresponsive_drone(drone_id);
     }
 
-    // Initialize the drone by assigning it a unique ID and sending initialization data
+    // drones_mutex must be held
+    void store_status(const int drone_id, const Status &status) {
+        fleet.updateStatus(drone_id, status);
+        fleet_changed = true;
+    }
+
+    // Update the sweep latency statistics and log them every sweep_report_interval sweeps
+    void record_sweep(const std::chrono::steady_clock::duration elapsed, const std::size_t drones) {
+        const double ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        SweepStats stats;
+        {
+            std::lock_guard lock(sweep_stats_mutex);
+            sweep_stats.sweeps++;
+            sweep_stats.drones = drones;
+            sweep_stats.last_ms = ms;
+            sweep_stats.mean_ms += (ms - sweep_stats.mean_ms) / static_cast<double>(std::min<std::size_t>(sweep_stats.sweeps, sweep_report_interval));
+            sweep_stats.max_ms = std::max(sweep_stats.max_ms, ms);
+            stats = sweep_stats;
+            if (sweep_stats.sweeps % sweep_report_interval == 0)
+                sweep_stats.max_ms = 0;
+        }
+        if (stats.sweeps % sweep_report_interval == 0)
+            logInfo("Tower", "Status sweep: " + std::to_string(stats.drones) + " drones, mean " + std::to_string(stats.mean_ms)
+                    + " ms, max " + std::to_string(stats.max_ms) + " ms over the last " + std::to_string(sweep_report_interval) + " sweeps");
+    }
+
+    void handle_unresponsive_drone(const int drone_id) {
+        // Where it was last seen, for the operators
+        std::string last_seen;
+        if (const GridLocation location = locate_drone(drone_id); location.cellIndex != -1)
+            last_seen = " Last seen in cell (" + std::to_string(location.cellX) + ", " + std::to_string(location.cellY)
+                        + "), sector " + std::to_string(location.sectorID) + ".";
+        std::cout << "Drone " << drone_id << " is not responding. Taking action!" << last_seen << std::endl;
+        logWarning("Tower", "Drone " + std::to_string(drone_id) + " is not responding. Taking action!" + last_seen);
+
+        bool vacated = false;
+        {
+            std::lock_guard lock(sectors_mutex);
+            std::lock_guard lock2(drones_mutex);
+            // Remove the drone from its sector
+            if (const int sectorID = fleet.getSectorID(drone_id); sectorID != -1) {
+                sectors[sectorID]->assignDrone(-1);
+                fleet.setSectorID(drone_id, -1);
+                free_sectors.release(sectorID);
+                vacated = true;
+            }
+            // Stop monitoring it and remove its status
+            if (fleet.isMonitored(drone_id)) {
+                fleet.setRole(drone_id, DroneRole::None);
+                fleet.clearStatus(drone_id);
+                fleet_changed = true;
+            }
+        }
+        // Send a ready drone to the sector it left, outside the locks the assignment takes
+        if (vacated)
+            request_assignment();
+        // Additional actions can be taken, such as alerting operators
+    }
+
+    // Initialize the drone by assigning it a unique ID and sending initialization data.
+    // Runs on the handshake workers: the drone takes the first free sector of free_sectors, which no other worker can
+    // claim, and is registered with its sector in a single update of the fleet table
     void initialize_drone(const std::string &drone_info_json) {
         // Parse the received drone "hello" message
         auto drone_info = nlohmann::json::parse(drone_info_json);
         const std::string drone_uuid = drone_info["drone_uuid"];
-        std::lock_guard lock(sectors_mutex);
 
         // Assign a unique drone ID
         int new_drone_id = ++drone_id_counter;
 
         // Create an initialization message with the assigned ID and an area to monitor
-        nlohmann::json init_message = {
-                {"drone_id", new_drone_id},
-                {"tower_position", tower_position}
-        };
-
-        {
-            std::lock_guard lock2(drones_mutex);
-            waiting_drones.insert(new_drone_id);
-            drone_initialization_time[new_drone_id] = std::chrono::system_clock::now();
-        }
+        wire::InitMessage init_message = {new_drone_id, tower_position, std::nullopt};
 
         // Assign the drone to a sector
-        for (const auto &sector : sectors) {
-            if (sector->getAssignedDroneID() == -1){
-                sector->assignDrone(new_drone_id);
-                drone_to_sector_map[new_drone_id] = sector;
-                {
-                    std::lock_guard lock2(drones_mutex);
-                    waiting_drones.erase(new_drone_id);
-                    active_drones.insert(new_drone_id);
-                }
-                Position startingPoint = sector->getStartingPoint();
-                init_message = {
-                        {"drone_id", new_drone_id},
-                        {"tower_position", tower_position},
-                        {"starting_point", startingPoint},
-                        {"timer", sector->getTimer()},
-                        {"tsp", sector->getTSP()}
-                };
-                break;
+        const int sectorID = free_sectors.claim();
+        {
+            std::lock_guard lock(drones_mutex);
+            fleet.add(new_drone_id, std::chrono::system_clock::now());
+            if (sectorID != -1) {
+                sectors[sectorID]->assignDrone(new_drone_id);
+                fleet.setRole(new_drone_id, DroneRole::Active);
+                fleet.setSectorID(new_drone_id, sectorID);
             }
         }
+        if (sectorID != -1)
+            init_message.assignment = wire::Assignment{*std::atomic_load(&sector_paths[sectorID]), sectors[sectorID]->getTimer()};
 
         // Send initialization message back to the drone
         const std::string drone_channel = "drone:" + drone_uuid + ":init";
-        redis->publish(drone_channel, init_message.dump());
+        redis->publish(drone_channel, wire::encodeInit(init_message, options.encoding));
 
         std::cout << "Drone " << drone_uuid << " initialized with ID: " << new_drone_id << std::endl;
         logInfo("Tower", "Drone " + std::string(drone_uuid) + " initialiazed with ID: " + std::to_string(new_drone_id));
@@ -300,150 +777,371 @@ private:
 };
 
 // Drone Client (for receiving commands and sending status updates)
+// Redis client shared by every drone of a process: one connection pool, and one subscriber connection on which the
+// tower's messages to the drones (drone:*:init, drone:*:commands, drone:*:path and drone:broadcast) are received and
+// routed by channel to the handlers registered by each drone
+class DroneMultiplexer : public std::enable_shared_from_this<DroneMultiplexer> {
+public:
+    using Handler = std::function<void(const std::string &)>;
+
+    // Connect and return once the subscriber listens to every drone channel
+    static std::shared_ptr<DroneMultiplexer> create(const std::string &host, const int port, const std::size_t pool_size) {
+        std::shared_ptr<DroneMultiplexer> multiplexer(new DroneMultiplexer(host, port, pool_size));
+        std::promise<void> subscribed;
+        auto ready = subscribed.get_future();
+        std::thread(&DroneMultiplexer::consume, multiplexer, std::move(subscribed)).detach();
+        ready.wait();
+        return multiplexer;
+    }
+
+    std::shared_ptr<Redis> get_redis_instance() {
+        return redis;
+    }
+
+    // Call handler with every message published on channel from now on. Handlers run on the subscriber thread and must
+    // not block; they may subscribe and unsubscribe. Returns the token to unsubscribe
+    uint64_t subscribe(const std::string &channel, Handler handler) {
+        std::lock_guard lock(handlers_mutex);
+        const uint64_t token = next_token++;
+        handlers[channel].emplace_back(token, std::make_shared<const Handler>(std::move(handler)));
+        return token;
+    }
+
+    void unsubscribe(const std::string &channel, const uint64_t token) {
+        std::lock_guard lock(handlers_mutex);
+        const auto it = handlers.find(channel);
+        if (it == handlers.end())
+            return;
+        auto &channel_handlers = it->second;
+        channel_handlers.erase(std::remove_if(channel_handlers.begin(), channel_handlers.end(),
+                                              [token](const auto &entry) { return entry.first == token; }),
+                               channel_handlers.end());
+        if (channel_handlers.empty())
+            handlers.erase(it);
+    }
+
+    // Block until the subscriber connection fails
+    void wait_until_closed() {
+        std::unique_lock lock(handlers_mutex);
+        closed_condition.wait(lock, [this] { return closed; });
+    }
+
+private:
+    std::shared_ptr<Redis> redis;
+    std::mutex handlers_mutex;
+    std::unordered_map<std::string, std::vector<std::pair<uint64_t, std::shared_ptr<const Handler>>>> handlers;
+    uint64_t next_token = 0;
+    bool closed = false;
+    std::condition_variable closed_condition;
+
+    DroneMultiplexer(const std::string &host, const int port, const std::size_t pool_size)
+        : redis(RedisCommunication(host, port, pool_size).get_redis_instance()) {}
+
+    void dispatch(const std::string &channel, const std::string &message) {
+        std::vector<std::shared_ptr<const Handler>> targets;
+        {
+            std::lock_guard lock(handlers_mutex);
+            const auto it = handlers.find(channel);
+            if (it == handlers.end())
+                return;     // No drone of this process listens to it
+            for (const auto &entry : it->second)
+                targets.push_back(entry.second);
+        }
+        for (const auto &handler : targets)
+            (*handler)(message);
+    }
+
+    void consume(std::promise<void> subscribed) {
+        auto subscriber = redis->subscriber();
+        int pending = 4;
+        subscriber.on_meta([&pending, &subscribed](Subscriber::MsgType type, OptionalString, long long) {
+            if ((type == Subscriber::MsgType::SUBSCRIBE || type == Subscriber::MsgType::PSUBSCRIBE) && --pending == 0)
+                subscribed.set_value();
+        });
+        subscriber.on_message([this](const std::string &channel, const std::string &message) {
+            dispatch(channel, message);
+        });
+        subscriber.on_pmessage([this](const std::string &, const std::string &channel, const std::string &message) {
+            dispatch(channel, message);
+        });
+        subscriber.psubscribe({"drone:*:init", "drone:*:commands", "drone:*:path"});
+        subscriber.subscribe("drone:broadcast");
+
+        try {
+            while (true)
+                subscriber.consume();
+        } catch (const Error &err) {
+            std::cerr << "Error consuming drone messages: " << err.what() << std::endl;
+        }
+        if (pending > 0)
+            subscribed.set_value();
+        {
+            std::lock_guard lock(handlers_mutex);
+            closed = true;
+        }
+        closed_condition.notify_all();
+    }
+};
+
+// What the drones append to the status_logs stream while monitoring
+struct StatusLogOptions {
+    bool cellEvents = false;        // One compact record per cell entered (wire::CellEvent) instead of every status
+    std::size_t maxLength = 0;      // Trim the stream to about this many entries (XADD MAXLEN ~), unbounded if 0
+};
+
 class DroneClient {
 public:
-     DroneClient(const std::shared_ptr<Redis> &redis, int timeScale)
-            : redis(redis), drone_uuid(generate_uuid()), timeScale(timeScale) {}
+    // Client that only sends, for drones whose messages are received elsewhere (the fleet simulator)
+     DroneClient(const std::shared_ptr<Redis> &redis, int timeScale, const wire::Encoding encoding = wire::Encoding::Binary)
+            : redis(redis), drone_uuid(generate_uuid()), timeScale(timeScale), encoding(encoding) {}
+
+    DroneClient(const std::shared_ptr<DroneMultiplexer> &multiplexer, int timeScale, const wire::Encoding encoding = wire::Encoding::Binary)
+            : DroneClient(multiplexer->get_redis_instance(), timeScale, encoding) {
+        this->multiplexer = multiplexer;
+    }
 
     // Send a handshake to the tower to register the drone
-    void connect_to_tower(const std::function<void(const nlohmann::json &)>& callback) {
-        // Listen for initialization message from the tower
-        std::thread init_listener_thread([this, callback]() {
-            this->listen_for_initialization(callback);
+    void connect_to_tower(const std::function<void(const wire::InitMessage &)>& callback) {
+        // Listen for initialization message from the tower, registered before the handshake so it cannot be missed
+        const Subscription init_channel = open_channel("drone:" + drone_uuid + ":init");
+        std::thread init_listener_thread([this, callback, init_channel]() {
+            this->listen_for_initialization(init_channel, callback);
         });
          init_listener_thread.detach();
-         std::this_thread::sleep_for(std::chrono::duration<float>(0.05 / timeScale));  // Wait for the listener to start
 
-        nlohmann::json handshake_message = {
+        send_handshake();
+    }
+
+    // Publish a handshake message to the tower, which answers on drone:<uuid>:init
+    void send_handshake() const
+    {
+        const nlohmann::json handshake_message = {
                 {"drone_uuid", drone_uuid}
         };
-
-        // Publish a handshake message to the tower
         redis->publish("drone:handshake", handshake_message.dump());
     }
 
-    // Start sleeping thread
-    void start_sleeping_thread(const nlohmann::json& message, float seconds) const
+    // Ask the tower to send the next drone to the sector
+    void send_go_next() const
     {
-        std::thread sleeping_thread([this, message, seconds]() {
-            std::this_thread::sleep_for(std::chrono::duration<float>(seconds / timeScale));
-            redis->publish("drone:go_next", message.dump());
+        const nlohmann::json message = {{"drone_id", drone_id}};
+        redis->publish("drone:go_next", message.dump());
+    }
+
+    // Ask for the next drone at deadline, the returned timer can be cancelled until then. The message is published by
+    // the sender pool, not on the timer worker
+    TimerWheel::TimerID schedule_go_next(const std::chrono::steady_clock::time_point deadline) const
+    {
+        return TimerWheel::shared().schedule(deadline, [this]() {
+            SenderPool::shared().post(static_cast<std::size_t>(drone_id), [this]() { send_go_next(); });
         });
-        sleeping_thread.detach();
     }
 
     std::shared_ptr<Redis> getRedisInstance() {
          return redis;
      }
 
-    // Start listening for commands after initialization
-    void listen_for_commands(const std::function<void(const nlohmann::json &)> &callback) const
+    [[nodiscard]] const std::string &get_uuid() const { return drone_uuid; }
+
+    [[nodiscard]] int get_drone_id() const { return drone_id; }
+
+    // For clients whose initialization message is received elsewhere (the fleet simulator)
+    void set_drone_id(const int id) { drone_id = id; }
+
+    // Print every status update to stdout (on by default)
+    void set_status_echo(const bool echo) { echo_status = echo; }
+
+    void set_status_log(const StatusLogOptions &options) { status_log = options; }
+
+    // Also publish every status on drone:status, for a tower started in event-driven mode (off by default: a polling
+    // tower only reads the status key, one write per status)
+    void set_status_push(const bool push) { push_status = push; }
+
+    // Start listening for commands after initialization, returns after the first valid one
+    void listen_for_commands(const std::function<void(const wire::Assignment &)> &callback) const
     {
-        const std::string drone_command_key = "drone:" + std::to_string(drone_id) + ":commands";
-         auto subscriber = redis->subscriber();
-        subscriber.subscribe(drone_command_key);
-         bool flag = true;
-
-         subscriber.on_message([&subscriber, &flag, callback, this](const std::string&, const std::string& message)
-         {
-             callback(nlohmann::json::parse(message));
-             subscriber.unsubscribe("drone:" + std::to_string(drone_id) + ":commands");
-             flag = false;
-         });
-
-         try
-         {
-             while (flag)
-                 subscriber.consume();
-         } catch (const Error &err)
-         {
-             std::cerr << "Error consuming command messages: " << err.what() << std::endl;
-         }
+        std::optional<wire::Assignment> command;
+        consume_channel(open_channel("drone:" + std::to_string(drone_id) + ":commands"), [this, &command](const std::string &message) {
+            command = wire::decodeCommand(message);
+            if (!command) {
+                std::cerr << "Invalid command message" << std::endl;
+                return true;
+            }
+            if (!(command->path.tsp = resolve_path(command->path)))
+                return true;
+            return false;
+        });
+        callback(*command);
     }
 
-    void listen_for_broadcasts(const std::function<void(const std::string &)> &callback) const
+    // Receive path updates for the sector being patrolled, runs until the process ends
+    void listen_for_path_updates(const std::function<void(const Sector::Waypoints &)> &callback) const
     {
-        auto subscriber = redis->subscriber();
-        subscriber.subscribe("drone:broadcast");
-         bool flag = true;
-
-        subscriber.on_message([&subscriber, &flag , callback](const std::string&, const std::string& message) {
-            callback(message);
-            subscriber.unsubscribe("drone:broadcast");
-            flag = false;
+        consume_channel(open_channel("drone:" + std::to_string(drone_id) + ":path"), [this, &callback](const std::string &message) {
+            const auto path = wire::decodePath(message);
+            if (!path) {
+                std::cerr << "Invalid path message" << std::endl;
+                return true;
+            }
+            if (const auto waypoints = resolve_path(*path))
+                callback(*waypoints);
+            return true;
         });
+    }
 
-        try {
-            while (flag)
-                subscriber.consume();
-        } catch (const Error &err) {
-            std::cerr << "Error consuming broadcast messages: " << err.what() << std::endl;
-        }
+    // Returns after the next broadcast
+    void listen_for_broadcasts(const std::function<void(const std::string &)> &callback) const
+    {
+        std::string broadcast;
+        consume_channel(open_channel("drone:broadcast"), [&broadcast](const std::string &message) {
+            broadcast = message;
+            return false;
+        });
+        callback(broadcast);
     }
 
     // Send status update to the tower
-    void send_status_update(const nlohmann::json &status) const
+    void send_status_update(const Status &status)
     {
         const std::string status_key = "drone:" + std::to_string(drone_id) + ":status";
-        redis->set(status_key, status.dump(), std::chrono::seconds(3));  // Update status in Redis with a TTL of 3 seconds
-        std::cout << "Drone " << drone_id << " status updated: " << status << std::endl;
-
-         if (status["state"] == "Monitoring") {
-             // Also append the status to a central Redis Stream
-             std::string stream_key = "status_logs";
-             nlohmann::json status_log = status;
-             status_log["timestamp"] = getCurrentTime();  // Include a timestamp
-
-             // Prepare fields for xadd
-             std::vector<std::pair<std::string, std::string>> fields = {{"status", status_log.dump()}};
-
-             // Add the status update to the central stream
-             redis->xadd(stream_key, "*", fields.begin(), fields.end());
+        const std::string payload = wire::encodeStatus(status, encoding);
+        redis->set(status_key, payload, std::chrono::seconds(3));  // Update status in Redis with a TTL of 3 seconds
+        if (push_status)
+            redis->publish("drone:status", payload);  // Push it to an event-driven tower
+        if (echo_status)
+            std::cout << "Drone " << drone_id << " status updated: " << DroneState::toString(status.state)
+                      << " at (" << status.position.x << ", " << status.position.y << "), battery " << status.batteryLevel << std::endl;
+
+        // Also append the status to a central Redis Stream, only while monitoring
+        if (status.state != DroneState::Monitoring) {
+            logged_cell.reset();
+            return;
+        }
+        const auto time = status.timestamp != std::chrono::system_clock::time_point{} ? status.timestamp : std::chrono::system_clock::now();
+        std::vector<std::pair<std::string, std::string>> fields;
+        if (status_log.cellEvents) {
+            // Only the cells entered, the Monitor does not need the samples in between
+            const std::pair<int, int> cell{static_cast<int>(std::floor(status.position.x / CELL_SIZE)),
+                                           static_cast<int>(std::floor(status.position.y / CELL_SIZE))};
+            if (logged_cell == cell)
+                return;
+            logged_cell = cell;
+            fields = {{"cell", wire::encodeCellEvent({status.droneID, cell.first, cell.second, time}, encoding)}};
+        }
+        else {
+            const nlohmann::json status_log_entry = {
+                {"drone_id", status.droneID},
+                {"position", status.position},
+                {"battery_level", status.batteryLevel},
+                {"state", DroneState::toString(status.state)},
+                {"timestamp", formatTime(time)}
+            };
+            fields = {{"status", status_log_entry.dump()}};
+        }
 
-         }
+        if (status_log.maxLength != 0)
+            redis->xadd("status_logs", "*", fields.begin(), fields.end(), static_cast<long long>(status_log.maxLength), true);
+        else
+            redis->xadd("status_logs", "*", fields.begin(), fields.end());
     }
 
 private:
+    // Messages of a channel queued for a drone thread
+    struct Subscription {
+        std::string channel;
+        uint64_t token;
+        std::shared_ptr<MessageQueue> queue;
+    };
+
     std::shared_ptr<Redis> redis;
+    std::shared_ptr<DroneMultiplexer> multiplexer;  // Receives the tower's messages, only for clients that listen
     std::string drone_uuid;     // Unique drone identifier
     int drone_id;               // Assigned after initialization
     int timeScale;
+    wire::Encoding encoding;    // Encoding of the status updates
+    bool echo_status = true;
+    bool push_status = false;
+    StatusLogOptions status_log;
+    std::optional<std::pair<int, int>> logged_cell;     // Last cell logged while monitoring
+
+    // Tours fetched from Redis, shared by the drones of this process
+    inline static std::mutex tour_cache_mutex;
+    inline static std::unordered_map<uint64_t, Sector::Waypoints> tour_cache;
+
+    std::optional<Sector::Waypoints> resolve_path(const wire::PathRef &path) const {
+        return resolve_path(*redis, path);
+    }
+
+public:
+    // Absolute waypoints of a path reference, fetching its tour from Redis the first time it is seen
+    static std::optional<Sector::Waypoints> resolve_path(Redis &redis, const wire::PathRef &path) {
+        if (path.tsp)
+            return path.tsp;
+        {
+            std::lock_guard lock(tour_cache_mutex);
+            if (const auto it = tour_cache.find(path.tourID); it != tour_cache.end())
+                return wire::expandPath(it->second, path);
+        }
+
+        std::optional<Sector::Waypoints> tour;
+        try {
+            if (const auto stored = redis.get(wire::tourKey(path.tourID)))
+                tour = wire::decodeTour(*stored, path.tourID);
+        } catch (const Error &err) {
+            std::cerr << "Error fetching " << wire::tourKey(path.tourID) << ": " << err.what() << std::endl;
+        }
+        if (!tour) {
+            std::cerr << "Missing or invalid " << wire::tourKey(path.tourID) << std::endl;
+            return std::nullopt;
+        }
+        {
+            std::lock_guard lock(tour_cache_mutex);
+            tour_cache.emplace(path.tourID, *tour);
+        }
+        return wire::expandPath(*tour, path);
+    }
 
+private:
     // Generate a UUID for the drone name
     std::string generate_uuid() {
         boost::uuids::uuid uuid = boost::uuids::random_generator()();
         return boost::uuids::to_string(uuid);
     }
 
-    // Listen for initialization message from the tower
-    void listen_for_initialization(const std::function<void(const nlohmann::json &)>& callback) {
-        auto subscriber = redis->subscriber();
-        std::string drone_channel = "drone:" + drone_uuid + ":init";
-        subscriber.subscribe(drone_channel);
+    [[nodiscard]] Subscription open_channel(const std::string &channel) const {
+        auto queue = std::make_shared<MessageQueue>();
+        const uint64_t token = multiplexer->subscribe(channel, [queue](const std::string &message) { queue->push(message); });
+        return {channel, token, std::move(queue)};
+    }
 
-        bool flag = true;
+    // Pass the messages of the subscription to handler on the calling thread until it returns false, then close it
+    void consume_channel(const Subscription &subscription, const std::function<bool(const std::string &)> &handler) const {
+        while (handler(subscription.queue->pop())) {}
+        multiplexer->unsubscribe(subscription.channel, subscription.token);
+    }
 
-        subscriber.on_message([this, callback, &subscriber, &flag](const std::string& channel, const std::string& message) {
+    // Listen for initialization message from the tower
+    void listen_for_initialization(const Subscription &init_channel, const std::function<void(const wire::InitMessage &)>& callback) {
+        std::optional<wire::InitMessage> init_message;
+        consume_channel(init_channel, [this, &init_message](const std::string &message) {
             // Parse the initialization message
-            auto init_message = nlohmann::json::parse(message);
-            drone_id = init_message["drone_id"];
-
-            std::cout << "Drone initialized with ID: " << drone_id << std::endl;
-
-            if (callback) {
-                callback(init_message);
-                subscriber.unsubscribe(channel);
-                flag = false;
+            init_message = wire::decodeInit(message);
+            if (!init_message) {
+                std::cerr << "Invalid initialization message" << std::endl;
+                return true;
             }
+            return false;
         });
 
-        // Wait for initialization message
-        try {
-            while(flag)
-                subscriber.consume();
-        } catch (const Error &err) {
-            std::cerr << "Error subscribing to initialization: " << err.what() << std::endl;
-        }
+        drone_id = init_message->droneID;
+        // Without its path the assignment is dropped, the drone then waits for a command
+        if (init_message->assignment && !(init_message->assignment->path.tsp = resolve_path(init_message->assignment->path)))
+            init_message->assignment.reset();
+
+        std::cout << "Drone initialized with ID: " << drone_id << std::endl;
+
+        if (callback)
+            callback(*init_message);
     }
 };
 
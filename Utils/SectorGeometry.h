@@ -0,0 +1,103 @@
+#ifndef SKYWATCHER_SECTORGEOMETRY_H
+#define SKYWATCHER_SECTORGEOMETRY_H
+
+#include <array>
+#include "Utils/Structs.h"
+
+// Sector side in cells, selected at build time (cmake -DSKYWATCHER_SECTOR_SIDE=20)
+#ifndef SKYWATCHER_SECTOR_SIDE
+#define SKYWATCHER_SECTOR_SIDE 10
+#endif
+
+constexpr float CELL_SIZE = 20;     // Cells are 20m x 20m
+
+namespace geometry {
+    // Write a rows x cols serpentine cycle (cell ids row * cols + col) into out, starting at cell 0.
+    // When either side is even every step is between adjacent cells, otherwise a single step is diagonal: both optimal
+    constexpr void serpentineCycle(const int rows, const int cols, int *out) {
+        // Sweep along the even side so the cycle can be closed with unit steps
+        const bool transpose = rows % 2 != 0 && cols % 2 == 0;
+        const int lanes = transpose ? cols : rows;
+        const int length = transpose ? rows : cols;
+        int k = 0;
+        auto emit = [&](const int lane, const int step) {
+            out[k++] = transpose ? step * cols + lane : lane * cols + step;
+        };
+
+        if (lanes % 2 == 0 && length >= 2) {
+            // First lane straight, snake the remaining lanes skipping the first step, come back along it
+            for (int s = 0; s < length; ++s)
+                emit(0, s);
+            for (int l = 1; l < lanes; ++l) {
+                if (l % 2 == 1)
+                    for (int s = length - 1; s >= 1; --s) emit(l, s);
+                else
+                    for (int s = 1; s < length; ++s) emit(l, s);
+            }
+            for (int l = lanes - 1; l >= 1; --l)
+                emit(l, 0);
+        } else if (lanes >= 3 && length >= 3) {
+            // Odd x odd lattices have no unit-step cycle, the best tour needs a single diagonal step:
+            // snake all but the last two lanes, zigzag across the last two, cut diagonally into the first step
+            for (int s = 0; s < length; ++s)
+                emit(0, s);
+            for (int l = 1; l < lanes - 2; ++l) {
+                if (l % 2 == 1)
+                    for (int s = length - 1; s >= 1; --s) emit(l, s);
+                else
+                    for (int s = 1; s < length; ++s) emit(l, s);
+            }
+            for (int s = length - 1; s >= 1; --s) {
+                const bool down = (length - 1 - s) % 2 == 0;
+                emit(down ? lanes - 2 : lanes - 1, s);
+                emit(down ? lanes - 1 : lanes - 2, s);
+            }
+            for (int l = lanes - 1; l >= 1; --l)
+                emit(l, 0);
+        } else {
+            // Single lane: plain boustrophedon
+            for (int l = 0; l < lanes; ++l) {
+                if (l % 2 == 0)
+                    for (int s = 0; s < length; ++s) emit(l, s);
+                else
+                    for (int s = length - 1; s >= 0; --s) emit(l, s);
+            }
+        }
+    }
+}
+
+// Compile-time layout of a Side x Side sector: waypoint i is the center of cell (i / Side, i % Side)
+template <int Side>
+struct SectorGeometry {
+    static_assert(Side >= 2, "A sector needs at least 2x2 cells");
+
+    static constexpr int side = Side;
+    static constexpr int cells = Side * Side;
+    using Waypoints = std::array<Position, cells>;
+
+    // Starting index of each region (0: top-left, 1: top-right, 2: bottom-left, 3: bottom-right),
+    // the corner of the sector closest to the center of the area
+    static constexpr std::array<int, 4> startingIndex = {cells - 1, (Side - 1) * Side, Side - 1, 0};
+
+    // Time in seconds for a drone at 30km/h to complete one patrol cycle of the sector
+    static constexpr int cycleTime = static_cast<int>(cells * CELL_SIZE * 36 / 300 + 0.5f);
+
+    // Optimal serpentine tour for each region, as waypoint indices starting from the region's starting index
+    static constexpr std::array<std::array<int, cells>, 4> canonicalTours = [] {
+        std::array<int, cells> cycle{};
+        geometry::serpentineCycle(Side, Side, cycle.data());
+        std::array<std::array<int, cells>, 4> tours{};
+        for (int region = 0; region < 4; ++region) {
+            int first = 0;
+            while (cycle[first] != startingIndex[region])
+                ++first;
+            for (int i = 0; i < cells; ++i)
+                tours[region][i] = cycle[(first + i) % cells];
+        }
+        return tours;
+    }();
+};
+
+using DefaultSectorGeometry = SectorGeometry<SKYWATCHER_SECTOR_SIDE>;
+
+#endif //SKYWATCHER_SECTORGEOMETRY_H
@@ -0,0 +1,91 @@
+#ifndef SKYWATCHER_SENDERPOOL_H
+#define SKYWATCHER_SENDERPOOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs blocking Redis writes (statuses, go_next) off the TimerWheel, whose workers are shared by every timer of the
+// process and must not block. Jobs are queued on one of a fixed set of sender threads picked by key, so the jobs of
+// one key (a drone ID) run one at a time and in the order they were posted, and a slow write only delays its own lane
+class SenderPool {
+public:
+    using Job = std::function<void()>;
+
+    explicit SenderPool(const unsigned laneCount = 2) {
+        for (unsigned i = 0; i < std::max(laneCount, 1u); i++)
+            lanes.push_back(std::make_unique<Lane>());
+        for (auto &lane : lanes)
+            lane->thread = std::thread(&SenderPool::run, lane.get());
+    }
+
+    ~SenderPool() {
+        for (auto &lane : lanes) {
+            {
+                std::lock_guard lock(lane->mutex);
+                lane->stopping = true;
+            }
+            lane->condition.notify_one();
+            lane->thread.join();
+        }
+    }
+
+    SenderPool(const SenderPool &) = delete;
+    SenderPool &operator=(const SenderPool &) = delete;
+
+    // Sender pool of the process, one lane per core (at least 2)
+    static SenderPool &shared() {
+        static SenderPool pool(std::max(2u, std::thread::hardware_concurrency()));
+        return pool;
+    }
+
+    void post(const std::size_t key, Job job) {
+        Lane &lane = *lanes[key % lanes.size()];
+        {
+            std::lock_guard lock(lane.mutex);
+            lane.jobs.push_back(std::move(job));
+        }
+        lane.condition.notify_one();
+    }
+
+private:
+    struct Lane {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Job> jobs;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Lane>> lanes;
+
+    // Jobs still queued when the pool stops are dropped. A failed write is reported and dropped too: statuses are
+    // sent again every second
+    static void run(Lane *lane) {
+        std::unique_lock lock(lane->mutex);
+        while (true) {
+            lane->condition.wait(lock, [lane] { return lane->stopping || !lane->jobs.empty(); });
+            if (lane->stopping)
+                return;
+            Job job = std::move(lane->jobs.front());
+            lane->jobs.pop_front();
+            lock.unlock();
+            try {
+                job();
+            } catch (const std::exception &e) {
+                std::cerr << "Send failed: " << e.what() << std::endl;
+            }
+            lock.lock();
+        }
+    }
+};
+
+
+#endif //SKYWATCHER_SENDERPOOL_H
@@ -1,5 +1,6 @@
 #ifndef SKYWATCHER_STRUCTS_H
 #define SKYWATCHER_STRUCTS_H
+#include <chrono>
 #include <nlohmann/json.hpp>
 
 struct Position {
@@ -63,13 +64,23 @@ struct DroneState {
         }
         return "Unknown";
     }
+
+    // Inverse of toString, unknown names map to Offline
+    [[nodiscard]] static Enum fromString (const std::string& state) {
+        for (int s = Ready; s < Offline; s++)
+            if (toString(static_cast<Enum>(s)) == state)
+                return static_cast<Enum>(s);
+        return Offline;
+    }
 };
 
 struct Status {
-    DroneState::Enum state;
-    Position position;
+    DroneState::Enum state = DroneState::Offline;
+    Position position = {0, 0};
 
-    double batteryLevel;
+    double batteryLevel = 0;
+    int droneID = -1;
+    std::chrono::system_clock::time_point timestamp{};     // Drone clock, epoch if unknown
 };
 
 #endif //SKYWATCHER_STRUCTS_H
@@ -0,0 +1,229 @@
+#ifndef SKYWATCHER_TIMERWHEEL_H
+#define SKYWATCHER_TIMERWHEEL_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Runs callbacks at absolute deadlines on a small fixed set of threads, instead of one sleeping thread per timer.
+// Timers sit in a hierarchical timing wheel: 4 levels of 256 slots, one tick per slot on the first level and 256 times
+// coarser on each next one. A timer lands on the level of the highest tick digit in which its deadline differs from the
+// current tick, and moves down a level each time that digit's slot comes up, so scheduling and cancelling are O(1).
+// The wheel thread only wakes up for the next occupied slot of the first level or the next cascade; callbacks run on
+// the worker threads and must not block for long
+class TimerWheel {
+public:
+    using TimerID = uint64_t;
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using PeriodicCallback = std::function<bool()>;     // Returns false to stop
+
+    explicit TimerWheel(const unsigned workerCount = 2, const Clock::duration tick = std::chrono::milliseconds(1))
+        : tick(tick), origin(Clock::now()) {
+        wheelThread = std::thread(&TimerWheel::runWheel, this);
+        for (unsigned i = 0; i < std::max(workerCount, 1u); i++)
+            workers.emplace_back(&TimerWheel::runWorker, this);
+    }
+
+    ~TimerWheel() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wheelCondition.notify_all();
+        workCondition.notify_all();
+        wheelThread.join();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    // Timer wheel of the process, one worker per core (at least 2)
+    static TimerWheel &shared() {
+        static TimerWheel wheel(std::max(2u, std::thread::hardware_concurrency()));
+        return wheel;
+    }
+
+    // Call callback once at deadline
+    TimerID schedule(const Clock::time_point deadline, Callback callback) {
+        return add(deadline, Clock::duration::zero(), [callback = std::move(callback)] {
+            callback();
+            return false;
+        });
+    }
+
+    // Call callback at first, first + period, first + 2 * period... until it returns false or the timer is cancelled.
+    // Deadlines are absolute: a late run does not delay the next ones, and periods missed entirely are skipped.
+    // Runs of one timer never overlap
+    TimerID scheduleEvery(const Clock::time_point first, const Clock::duration period, PeriodicCallback callback) {
+        return add(first, std::max(period, tick), std::move(callback));
+    }
+
+    // Returns false if the timer already fired (one-shot), stopped or was cancelled. A run in progress completes
+    bool cancel(const TimerID id) {
+        std::lock_guard lock(mutex);
+        return timers.erase(id) != 0;
+    }
+
+private:
+    static constexpr int levelCount = 4;
+    static constexpr int slotBits = 8;
+    static constexpr uint64_t slotCount = 1u << slotBits;
+    static constexpr uint64_t slotMask = slotCount - 1;
+
+    struct Timer {
+        uint64_t deadline;              // Tick
+        Clock::time_point first;        // Periodic timers
+        Clock::duration period;         // Zero for one-shot timers
+        PeriodicCallback callback;
+    };
+
+    const Clock::duration tick;
+    const Clock::time_point origin;
+
+    std::mutex mutex;
+    std::condition_variable wheelCondition;
+    std::condition_variable workCondition;
+    std::unordered_map<TimerID, Timer> timers;      // Cancelled timers are removed here, their slot entries are skipped
+    std::array<std::array<std::vector<TimerID>, slotCount>, levelCount> wheel;
+    std::vector<TimerID> overflow;                  // Deadlines beyond the last level
+    std::deque<TimerID> due;                        // Waiting for a worker
+    uint64_t currentTick = 0;                       // Every tick before it was processed
+    TimerID nextID = 1;
+    bool stopping = false;
+
+    std::thread wheelThread;
+    std::vector<std::thread> workers;
+
+    // First tick at or after time point
+    [[nodiscard]] uint64_t tickOf(const Clock::time_point time) const {
+        if (time <= origin)
+            return 0;
+        return static_cast<uint64_t>((time - origin + tick - Clock::duration(1)) / tick);
+    }
+
+    TimerID add(const Clock::time_point first, const Clock::duration period, PeriodicCallback callback) {
+        TimerID id;
+        {
+            std::lock_guard lock(mutex);
+            id = nextID++;
+            timers.emplace(id, Timer{tickOf(first), first, period, std::move(callback)});
+            place(id, timers.at(id).deadline);
+        }
+        wheelCondition.notify_one();
+        return id;
+    }
+
+    // mutex must be held
+    void place(const TimerID id, uint64_t deadline) {
+        deadline = std::max(deadline, currentTick);
+        const uint64_t difference = deadline ^ currentTick;
+        for (int level = 0; level < levelCount; level++) {
+            if ((difference >> (slotBits * (level + 1))) == 0) {
+                wheel[level][(deadline >> (slotBits * level)) & slotMask].push_back(id);
+                return;
+            }
+        }
+        overflow.push_back(id);
+    }
+
+    // Move the timers of a slot down the wheel, mutex must be held
+    void cascade(std::vector<TimerID> &slot) {
+        std::vector<TimerID> ids;
+        ids.swap(slot);
+        for (const TimerID id : ids)
+            if (const auto it = timers.find(id); it != timers.end())
+                place(id, it->second.deadline);
+    }
+
+    // mutex must be held
+    void processTick() {
+        // From the coarsest level down, so a timer can fall through several levels on the same tick
+        for (int level = levelCount - 1; level >= 1; level--) {
+            if ((currentTick & ((uint64_t{1} << (slotBits * level)) - 1)) != 0)
+                continue;
+            if (level == levelCount - 1)
+                cascade(overflow);
+            cascade(wheel[level][(currentTick >> (slotBits * level)) & slotMask]);
+        }
+
+        std::vector<TimerID> ids;
+        ids.swap(wheel[0][currentTick & slotMask]);
+        for (const TimerID id : ids)
+            if (timers.count(id) != 0)
+                due.push_back(id);
+    }
+
+    // Next tick worth waking up for: an occupied slot of the first level, or the next cascade
+    [[nodiscard]] uint64_t nextWakeTick() const {
+        const uint64_t nextCascade = (currentTick + slotMask) & ~slotMask;
+        for (uint64_t t = currentTick; t < nextCascade; t++)
+            if (!wheel[0][t & slotMask].empty())
+                return t;
+        return nextCascade;
+    }
+
+    void runWheel() {
+        std::unique_lock lock(mutex);
+        while (!stopping) {
+            const uint64_t now = static_cast<uint64_t>((Clock::now() - origin) / tick) + 1;    // Ticks already started
+            const std::size_t dueBefore = due.size();
+            while (currentTick < now) {
+                processTick();
+                currentTick++;
+            }
+            if (due.size() != dueBefore)
+                workCondition.notify_all();
+
+            wheelCondition.wait_until(lock, origin + tick * static_cast<int64_t>(nextWakeTick()));
+        }
+    }
+
+    void runWorker() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            workCondition.wait(lock, [this] { return stopping || !due.empty(); });
+            if (stopping)
+                return;
+            const TimerID id = due.front();
+            due.pop_front();
+            const auto it = timers.find(id);
+            if (it == timers.end())
+                continue;   // Cancelled while waiting for a worker
+
+            PeriodicCallback callback = std::move(it->second.callback);
+            lock.unlock();
+            const bool again = callback();
+            lock.lock();
+
+            const auto timer = timers.find(id);
+            if (timer == timers.end())
+                continue;   // Cancelled while running
+            if (!again || timer->second.period == Clock::duration::zero()) {
+                timers.erase(timer);
+                continue;
+            }
+            // Next deadline on the original grid, skipping the periods already over
+            Timer &periodic = timer->second;
+            periodic.callback = std::move(callback);
+            const auto elapsed = Clock::now() - periodic.first;
+            const auto periods = elapsed < Clock::duration::zero() ? 1 : elapsed / periodic.period + 1;
+            periodic.deadline = std::max(tickOf(periodic.first + periodic.period * periods), periodic.deadline + 1);
+            place(id, periodic.deadline);
+            wheelCondition.notify_one();
+        }
+    }
+};
+
+
+#endif //SKYWATCHER_TIMERWHEEL_H
@@ -0,0 +1,60 @@
+#ifndef SKYWATCHER_TRAJECTORY_H
+#define SKYWATCHER_TRAJECTORY_H
+
+#include <algorithm>
+#include <vector>
+#include "Structs.h"
+
+// Flight plan of a drone: straight legs flown back to back at constant speed. The position at any time is computed
+// on demand, so a flying drone only has to wake up when it reaches the end of the plan.
+// Times are in mission seconds; not thread safe
+class Trajectory {
+public:
+    struct Leg {
+        Position start;
+        Position end;
+        double departure;
+        double arrival;
+    };
+
+    // Stay at position until the next leg
+    void reset(const Position position) {
+        legs.clear();
+        origin = position;
+    }
+
+    // Fly from the end of the trajectory to destination in duration seconds, leaving at departure or on arrival of the
+    // previous leg if later. Returns the arrival time
+    double addLeg(const Position destination, double departure, const double duration) {
+        if (!legs.empty())
+            departure = std::max(departure, legs.back().arrival);
+        legs.push_back({end(), destination, departure, departure + std::max(duration, 0.0)});
+        return legs.back().arrival;
+    }
+
+    [[nodiscard]] Position positionAt(const double time) const {
+        // First leg departing after time, the drone is on the previous one
+        const auto next = std::upper_bound(legs.begin(), legs.end(), time,
+                                           [](const double t, const Leg &leg) { return t < leg.departure; });
+        if (next == legs.begin())
+            return origin;
+        const Leg &leg = *std::prev(next);
+        if (time >= leg.arrival)
+            return leg.end;
+        const double fraction = (time - leg.departure) / (leg.arrival - leg.departure);
+        return {leg.start.x + fraction * (leg.end.x - leg.start.x), leg.start.y + fraction * (leg.end.y - leg.start.y)};
+    }
+
+    // Position once every leg is flown
+    [[nodiscard]] Position end() const { return legs.empty() ? origin : legs.back().end; }
+
+    // Arrival time of the last leg, 0 if there is none
+    [[nodiscard]] double arrival() const { return legs.empty() ? 0.0 : legs.back().arrival; }
+
+private:
+    std::vector<Leg> legs;
+    Position origin{0, 0};
+};
+
+
+#endif //SKYWATCHER_TRAJECTORY_H
@@ -0,0 +1,502 @@
+#ifndef SKYWATCHER_WIREFORMAT_H
+#define SKYWATCHER_WIREFORMAT_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "Structs.h"
+#include "GridDefinitions.h"
+
+// Encoding of the messages exchanged between the tower and the drones.
+// Binary messages have a fixed little-endian layout, independent of the host, and start with
+//   magic (u8) | version (u8) | type (u8) | one type specific byte
+// Every decoder also accepts the JSON encoding (kept as a debug mode), told apart by its leading '{'
+namespace wire {
+    enum class Encoding {
+        Binary,
+        Json        // Human readable, for debugging with redis-cli
+    };
+
+    constexpr uint8_t magic = 0xB5;     // Never '{', the first byte of a JSON message
+    constexpr uint8_t version = 2;
+
+    enum class MessageType : uint8_t {
+        Status = 1,
+        Init = 2,
+        Command = 3,
+        Tour = 4,
+        Path = 5,
+        CellEvent = 6
+    };
+
+    // Times are sent as nanoseconds since the epoch (i64). The tick of system_clock is up to the standard library, so
+    // it never goes on the wire as is
+    inline int64_t toNanoseconds(const std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    inline std::chrono::system_clock::time_point fromNanoseconds(const int64_t nanoseconds) {
+        return std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+    }
+
+    // Status layout (32 bytes):
+    //   header (state in the 4th byte) | drone id (u32) | x, y (f32) | battery level (f32) | reserved (u32) | time (ns, i64)
+    constexpr std::size_t statusSize = 32;
+
+    // Cell entered by a monitoring drone, logged to the status_logs stream instead of every status.
+    // Layout (24 bytes): header | drone id (u32) | cell x, y (i32) | time (ns, i64)
+    struct CellEvent {
+        int droneID;
+        int cellX, cellY;       // Column and row of the cell, as in Grid::locate
+        std::chrono::system_clock::time_point timestamp;    // Drone clock
+    };
+    constexpr std::size_t cellEventSize = 24;
+
+    // Patrol path of a sector. Tours are stored once in Redis under tour:<id> (see encodeTour) as offsets from the
+    // starting point in the orientation of region 0; a path is that tour mirrored for the sector's region and
+    // translated to its starting point, so a handoff only carries the reference
+    struct PathRef {
+        Position startingPoint;
+        uint64_t tourID = 0;
+        uint8_t mirror = 0;                     // Region of the sector (bit 0: x flipped, bit 1: y flipped)
+        std::optional<Sector::Waypoints> tsp;   // Absolute path, when sent inline instead of by reference
+    };
+
+    // Sector handed to a drone: its patrol path and how long to patrol
+    struct Assignment {
+        PathRef path;
+        int timer;
+    };
+
+    // Path reference layout:
+    //   starting x, y (f32) | tour id (u64) | mirror (u8) | 1 if inline (u8) [| waypoint count (u32) | waypoints x, y (f32)]
+    // Init message layout:
+    //   header (1 in the 4th byte if an assignment follows) | drone id (u32) | tower x, y (f32) [| timer (i32) | path reference]
+    // Command message layout:
+    //   header | timer (i32) | path reference
+    // Path message layout (re-planned path of the sector being patrolled):
+    //   header | path reference
+    // Tour layout:
+    //   header | waypoint count (u32) | offsets x, y (f32)
+    // Positions are sent as f32: cell centers and positions on a metre grid are exact well beyond any area size
+    struct InitMessage {
+        int droneID;
+        Position towerPosition;
+        std::optional<Assignment> assignment;   // Empty when no sector was free
+    };
+
+    namespace detail {
+        class Writer {
+        public:
+            explicit Writer(const std::size_t capacity) { bytes.reserve(capacity); }
+
+            void u8(const uint8_t value) { bytes.push_back(static_cast<char>(value)); }
+            void i32(const int32_t value) { u32(static_cast<uint32_t>(value)); }
+            void u32(const uint32_t value) {
+                for (int i = 0; i < 4; ++i)
+                    bytes.push_back(static_cast<char>(value >> (8 * i)));
+            }
+            void u64(const uint64_t value) {
+                for (int i = 0; i < 8; ++i)
+                    bytes.push_back(static_cast<char>(value >> (8 * i)));
+            }
+            void f32(const double value) {
+                const auto narrowed = static_cast<float>(value);
+                uint32_t raw;
+                std::memcpy(&raw, &narrowed, sizeof(raw));
+                u32(raw);
+            }
+            void header(const MessageType type, const uint8_t extra) {
+                u8(magic);
+                u8(version);
+                u8(static_cast<uint8_t>(type));
+                u8(extra);
+            }
+
+            std::string bytes;
+        };
+
+        // Sequential reader, fails instead of reading past the end of the message
+        class Reader {
+        public:
+            explicit Reader(const std::string &bytes) : bytes(bytes) {}
+
+            bool u8(uint8_t &value) {
+                if (bytes.size() - offset < 1) return false;
+                value = static_cast<uint8_t>(bytes[offset++]);
+                return true;
+            }
+            bool u32(uint32_t &value) {
+                if (bytes.size() - offset < 4) return false;
+                value = 0;
+                for (int i = 0; i < 4; ++i)
+                    value |= static_cast<uint32_t>(static_cast<uint8_t>(bytes[offset++])) << (8 * i);
+                return true;
+            }
+            bool u64(uint64_t &value) {
+                if (bytes.size() - offset < 8) return false;
+                value = 0;
+                for (int i = 0; i < 8; ++i)
+                    value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[offset++])) << (8 * i);
+                return true;
+            }
+            bool i32(int32_t &value) {
+                uint32_t raw;
+                if (!u32(raw)) return false;
+                value = static_cast<int32_t>(raw);
+                return true;
+            }
+            bool f32(double &value) {
+                uint32_t raw;
+                if (!u32(raw)) return false;
+                float narrowed;
+                std::memcpy(&narrowed, &raw, sizeof(narrowed));
+                value = narrowed;
+                return true;
+            }
+            bool position(Position &value) { return f32(value.x) && f32(value.y); }
+            // Checks magic, version and type, returns the type specific byte
+            bool header(const MessageType type, uint8_t &extra) {
+                uint8_t m, v, t;
+                return u8(m) && u8(v) && u8(t) && u8(extra) && m == magic && v == version && t == static_cast<uint8_t>(type);
+            }
+            [[nodiscard]] bool done() const { return offset == bytes.size(); }
+
+        private:
+            const std::string &bytes;
+            std::size_t offset = 0;
+        };
+
+        inline bool isJson(const std::string &message) {
+            return !message.empty() && message.front() == '{';
+        }
+
+        inline void writeWaypoints(Writer &writer, const Sector::Waypoints &waypoints) {
+            writer.u32(static_cast<uint32_t>(waypoints.size()));
+            for (const auto &waypoint : waypoints) {
+                writer.f32(waypoint.x);
+                writer.f32(waypoint.y);
+            }
+        }
+
+        inline bool readWaypoints(Reader &reader, Sector::Waypoints &waypoints) {
+            uint32_t count;
+            if (!reader.u32(count) || count != waypoints.size())
+                return false;
+            for (auto &waypoint : waypoints)
+                if (!reader.position(waypoint))
+                    return false;
+            return true;
+        }
+
+        inline void writePath(Writer &writer, const PathRef &path) {
+            writer.f32(path.startingPoint.x);
+            writer.f32(path.startingPoint.y);
+            writer.u64(path.tourID);
+            writer.u8(path.mirror);
+            writer.u8(path.tsp ? 1 : 0);
+            if (path.tsp)
+                writeWaypoints(writer, *path.tsp);
+        }
+
+        inline bool readPath(Reader &reader, PathRef &path) {
+            uint8_t isInline;
+            if (!reader.position(path.startingPoint) || !reader.u64(path.tourID) || !reader.u8(path.mirror) || !reader.u8(isInline) || path.mirror > 3)
+                return false;
+            if (isInline) {
+                path.tsp.emplace();
+                return readWaypoints(reader, *path.tsp);
+            }
+            return true;
+        }
+
+        inline nlohmann::json pathToJson(const PathRef &path) {
+            nlohmann::json json = {{"starting_point", path.startingPoint}, {"tour_id", path.tourID}, {"mirror", path.mirror}};
+            if (path.tsp)
+                json["tsp"] = *path.tsp;
+            return json;
+        }
+
+        inline PathRef pathFromJson(const nlohmann::json &json) {
+            PathRef path{json.at("starting_point"), json.value("tour_id", uint64_t{0}), json.value("mirror", uint8_t{0}), std::nullopt};
+            if (json.contains("tsp"))
+                path.tsp = json.at("tsp").get<Sector::Waypoints>();
+            return path;
+        }
+
+        inline std::size_t pathCapacity(const PathRef &path) {
+            return 32 + (path.tsp ? sizeof(float) * 2 * path.tsp->size() : 0);
+        }
+
+        constexpr uint64_t fnvOffset = 14695981039346656037ull;
+        constexpr uint64_t fnvPrime = 1099511628211ull;
+
+        inline uint64_t fnv1a(const std::string &bytes) {
+            uint64_t hash = fnvOffset;
+            for (const char byte : bytes) {
+                hash ^= static_cast<uint8_t>(byte);
+                hash *= fnvPrime;
+            }
+            return hash;
+        }
+    }
+
+    // Redis key of a stored tour
+    inline std::string tourKey(const uint64_t tourID) {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string key = "tour:0000000000000000";
+        for (int i = 0; i < 16; ++i)
+            key[key.size() - 1 - i] = digits[(tourID >> (4 * i)) & 0xF];
+        return key;
+    }
+
+    // Mirror offsets for a region, its own inverse
+    inline Sector::Waypoints mirrorTour(const Sector::Waypoints &offsets, const uint8_t mirror) {
+        Sector::Waypoints mirrored;
+        for (std::size_t i = 0; i < offsets.size(); ++i)
+            mirrored[i] = {mirror & 1 ? -offsets[i].x : offsets[i].x, mirror & 2 ? -offsets[i].y : offsets[i].y};
+        return mirrored;
+    }
+
+    // Absolute path of a reference, given the stored tour offsets
+    inline Sector::Waypoints expandPath(const Sector::Waypoints &tour, const PathRef &path) {
+        Sector::Waypoints waypoints = mirrorTour(tour, path.mirror);
+        for (auto &waypoint : waypoints)
+            waypoint = waypoint + path.startingPoint;
+        return waypoints;
+    }
+
+    // Stored form of a tour, its ID is the hash of these bytes so drones can check what they fetched
+    inline std::string encodeTour(const Sector::Waypoints &tour) {
+        detail::Writer writer(8 + sizeof(float) * 2 * tour.size());
+        writer.header(MessageType::Tour, 0);
+        detail::writeWaypoints(writer, tour);
+        return std::move(writer.bytes);
+    }
+
+    inline uint64_t tourID(const std::string &encodedTour) {
+        return detail::fnv1a(encodedTour);
+    }
+
+    inline std::optional<Sector::Waypoints> decodeTour(const std::string &message, const uint64_t expectedID) {
+        if (tourID(message) != expectedID)
+            return std::nullopt;
+        detail::Reader reader(message);
+        uint8_t unused;
+        Sector::Waypoints tour;
+        if (!reader.header(MessageType::Tour, unused) || !detail::readWaypoints(reader, tour) || !reader.done())
+            return std::nullopt;
+        return tour;
+    }
+
+    inline std::string encodeStatus(const Status &status, const Encoding encoding) {
+        if (encoding == Encoding::Json) {
+            const nlohmann::json json = {
+                {"drone_id", status.droneID},
+                {"position", status.position},
+                {"battery_level", status.batteryLevel},
+                {"state", DroneState::toString(status.state)},
+                {"timestamp", toNanoseconds(status.timestamp)}
+            };
+            return json.dump();
+        }
+        detail::Writer writer(statusSize);
+        writer.header(MessageType::Status, static_cast<uint8_t>(status.state));
+        writer.u32(static_cast<uint32_t>(status.droneID));
+        writer.f32(status.position.x);
+        writer.f32(status.position.y);
+        writer.f32(status.batteryLevel);
+        writer.u32(0);
+        writer.u64(static_cast<uint64_t>(toNanoseconds(status.timestamp)));
+        return std::move(writer.bytes);
+    }
+
+    inline std::optional<Status> decodeStatus(const std::string &message) {
+        Status status;
+        if (detail::isJson(message)) {
+            try {
+                const auto json = nlohmann::json::parse(message);
+                status.droneID = json.at("drone_id");
+                status.position = json.at("position");
+                status.batteryLevel = json.at("battery_level");
+                status.state = DroneState::fromString(json.at("state"));
+                status.timestamp = fromNanoseconds(json.value("timestamp", int64_t{0}));
+            } catch (const nlohmann::json::exception &) {
+                return std::nullopt;
+            }
+            return status;
+        }
+
+        if (message.size() != statusSize)
+            return std::nullopt;
+        detail::Reader reader(message);
+        uint8_t state;
+        uint32_t id, reserved;
+        uint64_t timestamp;
+        if (!reader.header(MessageType::Status, state) || state > DroneState::Offline || !reader.u32(id)
+            || !reader.position(status.position) || !reader.f32(status.batteryLevel) || !reader.u32(reserved) || !reader.u64(timestamp))
+            return std::nullopt;
+        status.state = static_cast<DroneState::Enum>(state);
+        status.droneID = static_cast<int32_t>(id);
+        status.timestamp = fromNanoseconds(static_cast<int64_t>(timestamp));
+        return status;
+    }
+
+    inline std::string encodeCellEvent(const CellEvent &event, const Encoding encoding) {
+        if (encoding == Encoding::Json)
+            return nlohmann::json{{"drone_id", event.droneID}, {"cell", {event.cellX, event.cellY}}, {"timestamp", toNanoseconds(event.timestamp)}}.dump();
+        detail::Writer writer(cellEventSize);
+        writer.header(MessageType::CellEvent, 0);
+        writer.u32(static_cast<uint32_t>(event.droneID));
+        writer.i32(event.cellX);
+        writer.i32(event.cellY);
+        writer.u64(static_cast<uint64_t>(toNanoseconds(event.timestamp)));
+        return std::move(writer.bytes);
+    }
+
+    inline std::optional<CellEvent> decodeCellEvent(const std::string &message) {
+        CellEvent event{};
+        if (detail::isJson(message)) {
+            try {
+                const auto json = nlohmann::json::parse(message);
+                event.droneID = json.at("drone_id");
+                event.cellX = json.at("cell").at(0);
+                event.cellY = json.at("cell").at(1);
+                event.timestamp = fromNanoseconds(json.at("timestamp").get<int64_t>());
+            } catch (const nlohmann::json::exception &) {
+                return std::nullopt;
+            }
+            return event;
+        }
+
+        if (message.size() != cellEventSize)
+            return std::nullopt;
+        detail::Reader reader(message);
+        uint8_t unused;
+        uint32_t id;
+        uint64_t timestamp;
+        if (!reader.header(MessageType::CellEvent, unused) || !reader.u32(id) || !reader.i32(event.cellX) || !reader.i32(event.cellY)
+            || !reader.u64(timestamp))
+            return std::nullopt;
+        event.droneID = static_cast<int32_t>(id);
+        event.timestamp = fromNanoseconds(static_cast<int64_t>(timestamp));
+        return event;
+    }
+
+    inline std::string encodeInit(const InitMessage &init, const Encoding encoding) {
+        if (encoding == Encoding::Json) {
+            nlohmann::json json = init.assignment ? detail::pathToJson(init.assignment->path) : nlohmann::json::object();
+            if (init.assignment)
+                json["timer"] = init.assignment->timer;
+            json["drone_id"] = init.droneID;
+            json["tower_position"] = init.towerPosition;
+            return json.dump();
+        }
+        detail::Writer writer(16 + (init.assignment ? 4 + detail::pathCapacity(init.assignment->path) : 0));
+        writer.header(MessageType::Init, init.assignment ? 1 : 0);
+        writer.u32(static_cast<uint32_t>(init.droneID));
+        writer.f32(init.towerPosition.x);
+        writer.f32(init.towerPosition.y);
+        if (init.assignment) {
+            writer.i32(init.assignment->timer);
+            detail::writePath(writer, init.assignment->path);
+        }
+        return std::move(writer.bytes);
+    }
+
+    inline std::optional<InitMessage> decodeInit(const std::string &message) {
+        InitMessage init;
+        if (detail::isJson(message)) {
+            try {
+                const auto json = nlohmann::json::parse(message);
+                init.droneID = json.at("drone_id");
+                init.towerPosition = json.at("tower_position");
+                if (json.contains("timer"))
+                    init.assignment = Assignment{detail::pathFromJson(json), json.at("timer")};
+            } catch (const nlohmann::json::exception &) {
+                return std::nullopt;
+            }
+            return init;
+        }
+
+        detail::Reader reader(message);
+        uint8_t hasAssignment;
+        uint32_t id;
+        if (!reader.header(MessageType::Init, hasAssignment) || !reader.u32(id) || !reader.position(init.towerPosition))
+            return std::nullopt;
+        init.droneID = static_cast<int32_t>(id);
+        if (hasAssignment) {
+            init.assignment.emplace();
+            if (!reader.i32(init.assignment->timer) || !detail::readPath(reader, init.assignment->path))
+                return std::nullopt;
+        }
+        if (!reader.done())
+            return std::nullopt;
+        return init;
+    }
+
+    inline std::string encodeCommand(const Assignment &command, const Encoding encoding) {
+        if (encoding == Encoding::Json) {
+            nlohmann::json json = detail::pathToJson(command.path);
+            json["timer"] = command.timer;
+            return json.dump();
+        }
+        detail::Writer writer(8 + detail::pathCapacity(command.path));
+        writer.header(MessageType::Command, 0);
+        writer.i32(command.timer);
+        detail::writePath(writer, command.path);
+        return std::move(writer.bytes);
+    }
+
+    inline std::optional<Assignment> decodeCommand(const std::string &message) {
+        Assignment command;
+        if (detail::isJson(message)) {
+            try {
+                const auto json = nlohmann::json::parse(message);
+                command = {detail::pathFromJson(json), json.at("timer")};
+            } catch (const nlohmann::json::exception &) {
+                return std::nullopt;
+            }
+            return command;
+        }
+
+        detail::Reader reader(message);
+        uint8_t unused;
+        if (!reader.header(MessageType::Command, unused) || !reader.i32(command.timer) || !detail::readPath(reader, command.path) || !reader.done())
+            return std::nullopt;
+        return command;
+    }
+
+    inline std::string encodePath(const PathRef &path, const Encoding encoding) {
+        if (encoding == Encoding::Json)
+            return detail::pathToJson(path).dump();
+        detail::Writer writer(4 + detail::pathCapacity(path));
+        writer.header(MessageType::Path, 0);
+        detail::writePath(writer, path);
+        return std::move(writer.bytes);
+    }
+
+    inline std::optional<PathRef> decodePath(const std::string &message) {
+        PathRef path;
+        if (detail::isJson(message)) {
+            try {
+                path = detail::pathFromJson(nlohmann::json::parse(message));
+            } catch (const nlohmann::json::exception &) {
+                return std::nullopt;
+            }
+            return path;
+        }
+
+        detail::Reader reader(message);
+        uint8_t unused;
+        if (!reader.header(MessageType::Path, unused) || !detail::readPath(reader, path) || !reader.done())
+            return std::nullopt;
+        return path;
+    }
+}
+
+#endif //SKYWATCHER_WIREFORMAT_H